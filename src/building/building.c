@@ -9,6 +9,7 @@
 #include "building/properties.h"
 #include "building/rotation.h"
 #include "building/storage.h"
+#include "building/storage_index.h"
 #include "city/buildings.h"
 #include "city/finance.h"
 #include "city/population.h"
@@ -30,10 +31,18 @@
 
 #define BUILDING_ARRAY_SIZE_STEP 2000
 
+typedef struct {
+    int *ids;
+    int size;
+    int capacity;
+    int incomplete;
+} id_list;
+
 static struct {
     array(building) buildings;
     building *first_of_type[BUILDING_TYPE_MAX];
     building *last_of_type[BUILDING_TYPE_MAX];
+    id_list index[BUILDING_INDEX_MAX];
 } data;
 
 static struct {
@@ -67,6 +76,103 @@ building *building_first_of_type(building_type type)
     return data.first_of_type[type];
 }
 
+static int find_in_list(const id_list *list, int id)
+{
+    int low = 0;
+    int high = list->size;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (list->ids[middle] < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void add_to_list(id_list *list, int id)
+{
+    if (list->incomplete) {
+        // Rebuilt from the building array when it is next used
+        return;
+    }
+    int position = find_in_list(list, id);
+    if (position < list->size && list->ids[position] == id) {
+        return;
+    }
+    if (list->size >= list->capacity) {
+        int capacity = list->capacity + BUILDING_ARRAY_SIZE_STEP;
+        int *ids = realloc(list->ids, capacity * sizeof(int));
+        if (!ids) {
+            log_error("Unable to allocate enough memory for the building index. Checking all buildings instead.", 0, 0);
+            list->incomplete = 1;
+            return;
+        }
+        list->ids = ids;
+        list->capacity = capacity;
+    }
+    memmove(&list->ids[position + 1], &list->ids[position], (list->size - position) * sizeof(int));
+    list->ids[position] = id;
+    list->size++;
+}
+
+static void remove_from_list(id_list *list, int id)
+{
+    int position = find_in_list(list, id);
+    if (position < list->size && list->ids[position] == id) {
+        list->size--;
+        memmove(&list->ids[position], &list->ids[position + 1], (list->size - position) * sizeof(int));
+    }
+}
+
+static void clear_index(void)
+{
+    for (int i = 0; i < BUILDING_INDEX_MAX; i++) {
+        data.index[i].size = 0;
+        data.index[i].incomplete = 0;
+    }
+    building_storage_index_invalidate();
+}
+
+static int index_contains(building_index index, const building *b)
+{
+    return b->state != BUILDING_STATE_UNUSED && (index != BUILDING_INDEX_NON_HOUSES || !building_is_house(b->type));
+}
+
+static int rebuild_list(building_index index)
+{
+    id_list *list = &data.index[index];
+    if (list->capacity < data.buildings.size) {
+        int *ids = realloc(list->ids, data.buildings.size * sizeof(int));
+        if (!ids) {
+            return 0;
+        }
+        list->ids = ids;
+        list->capacity = data.buildings.size;
+    }
+    list->size = 0;
+    building *b;
+    array_foreach(data.buildings, b)
+    {
+        if (index_contains(index, b)) {
+            list->ids[list->size++] = b->id;
+        }
+    }
+    list->incomplete = 0;
+    return 1;
+}
+
+const int *building_index_ids(building_index index, int *num_ids)
+{
+    if (data.index[index].incomplete && !rebuild_list(index)) {
+        *num_ids = data.buildings.size;
+        return 0;
+    }
+    *num_ids = data.index[index].size;
+    return data.index[index].ids;
+}
+
 building *building_main(building *b)
 {
     for (int guard = 0; guard < 9; guard++) {
@@ -83,8 +189,21 @@ building *building_next(building *b)
     return array_item(data.buildings, b->next_part_building_id);
 }
 
+static int is_storage_type(building_type type)
+{
+    return type == BUILDING_WAREHOUSE || type == BUILDING_GRANARY;
+}
+
 static void fill_adjacent_types(building *b)
 {
+    for (int i = 0; i < BUILDING_INDEX_MAX; i++) {
+        if (index_contains(i, b)) {
+            add_to_list(&data.index[i], b->id);
+        }
+    }
+    if (is_storage_type(b->type)) {
+        building_storage_index_invalidate();
+    }
     building *first = data.first_of_type[b->type];
     building *last = data.last_of_type[b->type];
     if (!first || !last) {
@@ -121,6 +240,11 @@ static void fill_adjacent_types(building *b)
 
 static void remove_adjacent_types(building *b)
 {
+    remove_from_list(&data.index[BUILDING_INDEX_ALL], b->id);
+    remove_from_list(&data.index[BUILDING_INDEX_NON_HOUSES], b->id);
+    if (is_storage_type(b->type)) {
+        building_storage_index_invalidate();
+    }
     building *first = data.first_of_type[b->type];
     building *last = data.last_of_type[b->type];
     if (b == first && b == last) {
@@ -364,9 +488,12 @@ void building_update_state(void)
     int wall_recalc = 0;
     int road_recalc = 0;
     int aqueduct_recalc = 0;
-    building *b;
-    array_foreach(data.buildings, b)
-    {
+    int num_ids;
+    const int *ids = building_index_ids(BUILDING_INDEX_ALL, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        int i = ids ? ids[n] : n;
+        building *b = building_get(i);
+        int deleted = 1;
         if (b->state == BUILDING_STATE_CREATED) {
             b->state = BUILDING_STATE_IN_USE;
         }
@@ -399,6 +526,13 @@ void building_update_state(void)
             building_delete(b);
         } else if (b->state == BUILDING_STATE_DELETED_BY_GAME) {
             building_delete(b);
+        } else {
+            deleted = 0;
+        }
+        // The deleted building left the index, so the next one moved into its place
+        if (deleted && ids) {
+            n--;
+            num_ids--;
         }
     }
     if (wall_recalc) {
@@ -417,9 +551,10 @@ void building_update_state(void)
 
 void building_update_desirability(void)
 {
-    building *b;
-    array_foreach(data.buildings, b)
-    {
+    int num_ids;
+    const int *ids = building_index_ids(BUILDING_INDEX_ALL, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        building *b = building_get(ids ? ids[n] : n);
         if (b->state != BUILDING_STATE_IN_USE) {
             continue;
         }
@@ -604,6 +739,7 @@ void building_clear_all(void)
 {
     memset(data.first_of_type, 0, sizeof(data.first_of_type));
     memset(data.last_of_type, 0, sizeof(data.last_of_type));
+    clear_index();
 
     if (!array_init(data.buildings, BUILDING_ARRAY_SIZE_STEP, initialize_new_building, building_in_use) ||
         !array_next(data.buildings)) { // Ignore first building
@@ -655,6 +791,7 @@ void building_load_state(buffer *buf, buffer *sequence, buffer *corrupt_houses,
 
     memset(data.first_of_type, 0, sizeof(data.first_of_type));
     memset(data.last_of_type, 0, sizeof(data.last_of_type));
+    clear_index();
 
     int highest_id_in_use = 0;
 
@@ -187,6 +187,17 @@ int building_find(building_type type);
 
 building *building_first_of_type(building_type type);
 
+typedef enum {
+    BUILDING_INDEX_ALL = 0,
+    BUILDING_INDEX_NON_HOUSES = 1,
+    BUILDING_INDEX_MAX = 2
+} building_index;
+
+// Ids of the buildings that are not unused, in ascending order, without the holes of the building array.
+// The list changes when a building is created, deleted or changes type.
+// Returns 0 if the index could not be allocated: then *num_ids is building_count() and the caller checks every id.
+const int *building_index_ids(building_index index, int *num_ids);
+
 void building_change_type(building *b, building_type type);
 
 building *building_main(building *b);
@@ -86,7 +86,10 @@ void building_count_update(void)
     city_buildings_reset_dock_wharf_counters();
     city_health_reset_hospital_workers();
 
-    for (int i = 1; i < building_count(); i++) {
+    int num_ids;
+    const int *ids = building_index_ids(BUILDING_INDEX_NON_HOUSES, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        int i = ids ? ids[n] : n;
         building *b = building_get(i);
         if (b->state != BUILDING_STATE_IN_USE || b->house_size) {
             continue;
@@ -3,6 +3,7 @@
 #include "building/destruction.h"
 #include "building/model.h"
 #include "building/storage.h"
+#include "building/storage_index.h"
 #include "building/warehouse.h"
 #include "city/finance.h"
 #include "city/message.h"
@@ -346,13 +347,27 @@ int building_granary_for_storing(int x, int y, int resource, int road_network_id
     }
     int min_dist = INFINITE;
     int min_building_id = 0;
-    for (building *b = building_first_of_type(BUILDING_GRANARY); b; b = b->next_of_type) {
-        if (b->road_network_id != road_network_id ||
-            !building_granary_accepts_storage(b, resource, understaffed)) {
+    int num_ids;
+    const int *ids = building_storage_index_nearest(BUILDING_GRANARY, road_network_id, RESOURCE_NONE, x, y, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        building *b = building_get(ids ? ids[n] : n);
+        if (b->type != BUILDING_GRANARY || b->road_network_id != road_network_id) {
             continue;
         }
-        // there is room
         int dist = calc_maximum_distance(b->x + 1, b->y + 1, x, y);
+        // A granary that can't be closer only matters when it is counted as understaffed
+        if (dist >= min_dist &&
+            (!understaffed || calc_percentage(b->num_workers, model_get_building(b->type)->laborers) >= 100)) {
+            if (ids && !understaffed) {
+                // Nearest first: none of the remaining granaries is closer
+                break;
+            }
+            continue;
+        }
+        if (!building_granary_accepts_storage(b, resource, understaffed)) {
+            continue;
+        }
+        // there is room
         if (dist < min_dist) {
             min_dist = dist;
             min_building_id = b->id;
@@ -377,8 +392,11 @@ int building_getting_granary_for_storing(int x, int y, int resource, int road_ne
     }
     int min_dist = INFINITE;
     int min_building_id = 0;
-    for (building *b = building_first_of_type(BUILDING_GRANARY); b; b = b->next_of_type) {
-        if (b->state != BUILDING_STATE_IN_USE) {
+    int num_ids;
+    const int *ids = building_storage_index_nearest(BUILDING_GRANARY, road_network_id, RESOURCE_NONE, x, y, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        building *b = building_get(ids ? ids[n] : n);
+        if (b->type != BUILDING_GRANARY || b->state != BUILDING_STATE_IN_USE) {
             continue;
         }
         if (!b->has_road_access || b->distance_from_entry <= 0 || b->road_network_id != road_network_id) {
@@ -399,6 +417,10 @@ int building_getting_granary_for_storing(int x, int y, int resource, int road_ne
                 min_dist = dist;
                 min_building_id = b->id;
             }
+            if (ids) {
+                // Nearest first: this is the closest one
+                break;
+            }
         }
     }
     building *min = building_get(min_building_id);
@@ -4,6 +4,7 @@
 #include "building/destruction.h"
 #include "building/list.h"
 #include "building/monument.h"
+#include "building/storage_index.h"
 #include "city/buildings.h"
 #include "city/map.h"
 #include "city/message.h"
@@ -352,6 +353,8 @@ void building_maintenance_check_rome_access(void)
             }
         }
     }
+    // The warehouses and granaries may have moved to another road network
+    building_storage_index_invalidate();
     const map_tile *exit_point = city_map_exit_point();
     if (!map_routing_distance(exit_point->grid_offset)) {
         // no route through city
@@ -0,0 +1,217 @@
+#include "storage_index.h"
+
+#include "core/calc.h"
+#include "core/log.h"
+#include "game/resource.h"
+#include "map/road_network.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ROAD_NETWORKS 256
+
+typedef struct {
+    int building_id;
+    int x;
+    int y;
+    int resources; // warehouses only: a bit for each resource stored
+} storage_entry;
+
+typedef struct {
+    storage_entry *entries; // by road network, then by building id
+    int size;
+    int capacity;
+    int first[MAX_ROAD_NETWORKS];
+    int count[MAX_ROAD_NETWORKS];
+} storage_list;
+
+typedef struct {
+    int distance;
+    int building_id;
+} nearest_storage;
+
+enum {
+    LIST_WAREHOUSES = 0,
+    LIST_GRANARIES = 1,
+    LIST_MAX = 2
+};
+
+static struct {
+    int is_valid;
+    int allocation_failed;
+    int road_network_version;
+    storage_list lists[LIST_MAX];
+    nearest_storage *nearest;
+    int *nearest_ids;
+    int nearest_capacity;
+} data;
+
+void building_storage_index_invalidate(void)
+{
+    data.is_valid = 0;
+}
+
+static int stored_resources(building *warehouse)
+{
+    int resources = 0;
+    building *space = warehouse;
+    for (int i = 0; i < 8; i++) {
+        space = building_next(space);
+        if (space->id > 0 && space->loads_stored > 0) {
+            resources |= 1 << space->subtype.warehouse_resource_id;
+        }
+    }
+    return resources;
+}
+
+static int rebuild_list(storage_list *list, building_type type)
+{
+    int size = 0;
+    for (building *b = building_first_of_type(type); b; b = b->next_of_type) {
+        size++;
+    }
+    if (size > list->capacity) {
+        storage_entry *entries = realloc(list->entries, size * sizeof(storage_entry));
+        if (!entries) {
+            return 0;
+        }
+        list->entries = entries;
+        list->capacity = size;
+    }
+    list->size = size;
+
+    memset(list->count, 0, sizeof(list->count));
+    for (building *b = building_first_of_type(type); b; b = b->next_of_type) {
+        list->count[b->road_network_id]++;
+    }
+    int next[MAX_ROAD_NETWORKS];
+    int first = 0;
+    for (int i = 0; i < MAX_ROAD_NETWORKS; i++) {
+        list->first[i] = next[i] = first;
+        first += list->count[i];
+    }
+    for (building *b = building_first_of_type(type); b; b = b->next_of_type) {
+        storage_entry *entry = &list->entries[next[b->road_network_id]++];
+        entry->building_id = b->id;
+        if (type == BUILDING_GRANARY) {
+            entry->x = b->x + 1;
+            entry->y = b->y + 1;
+            entry->resources = 0;
+        } else {
+            entry->x = b->x;
+            entry->y = b->y;
+            entry->resources = stored_resources(b);
+        }
+    }
+    return 1;
+}
+
+static int reserve_nearest(void)
+{
+    int capacity = 1;
+    for (int i = 0; i < LIST_MAX; i++) {
+        if (data.lists[i].size > capacity) {
+            capacity = data.lists[i].size;
+        }
+    }
+    if (capacity <= data.nearest_capacity) {
+        return 1;
+    }
+    nearest_storage *nearest = realloc(data.nearest, capacity * sizeof(nearest_storage));
+    if (!nearest) {
+        return 0;
+    }
+    data.nearest = nearest;
+    int *nearest_ids = realloc(data.nearest_ids, capacity * sizeof(int));
+    if (!nearest_ids) {
+        return 0;
+    }
+    data.nearest_ids = nearest_ids;
+    data.nearest_capacity = capacity;
+    return 1;
+}
+
+static int update_index(void)
+{
+    if (data.is_valid && data.road_network_version == map_road_network_version()) {
+        return 1;
+    }
+    if (!rebuild_list(&data.lists[LIST_WAREHOUSES], BUILDING_WAREHOUSE) ||
+        !rebuild_list(&data.lists[LIST_GRANARIES], BUILDING_GRANARY) || !reserve_nearest()) {
+        if (!data.allocation_failed) {
+            log_error("Unable to allocate enough memory for the storage index. Checking all buildings instead.", 0, 0);
+            data.allocation_failed = 1;
+        }
+        data.is_valid = 0;
+        return 0;
+    }
+    data.allocation_failed = 0;
+    data.is_valid = 1;
+    data.road_network_version = map_road_network_version();
+    return 1;
+}
+
+void building_storage_index_update_warehouse(building *warehouse)
+{
+    if (!data.is_valid || warehouse->type != BUILDING_WAREHOUSE) {
+        return;
+    }
+    storage_list *list = &data.lists[LIST_WAREHOUSES];
+    int low = list->first[warehouse->road_network_id];
+    int high = low + list->count[warehouse->road_network_id];
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (list->entries[middle].building_id < warehouse->id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low < list->size && list->entries[low].building_id == warehouse->id) {
+        list->entries[low].resources = stored_resources(warehouse);
+    } else {
+        // Not where its road network says it should be: rebuild the index when it is next used
+        data.is_valid = 0;
+    }
+}
+
+static int compare_nearest(const void *a, const void *b)
+{
+    const nearest_storage *storage_a = a;
+    const nearest_storage *storage_b = b;
+    if (storage_a->distance != storage_b->distance) {
+        return storage_a->distance - storage_b->distance;
+    }
+    return storage_a->building_id - storage_b->building_id;
+}
+
+const int *building_storage_index_nearest(building_type type, int road_network_id, int resource,
+    int x, int y, int *num_ids)
+{
+    if (!update_index()) {
+        *num_ids = building_count();
+        return 0;
+    }
+    *num_ids = 0;
+    if (road_network_id < 0 || road_network_id >= MAX_ROAD_NETWORKS) {
+        return data.nearest_ids;
+    }
+    const storage_list *list = &data.lists[type == BUILDING_GRANARY ? LIST_GRANARIES : LIST_WAREHOUSES];
+    int resource_bit = resource != RESOURCE_NONE ? 1 << resource : 0;
+    int count = 0;
+    for (int i = 0; i < list->count[road_network_id]; i++) {
+        const storage_entry *entry = &list->entries[list->first[road_network_id] + i];
+        if (resource_bit && !(entry->resources & resource_bit)) {
+            continue;
+        }
+        data.nearest[count].distance = calc_maximum_distance(entry->x, entry->y, x, y);
+        data.nearest[count].building_id = entry->building_id;
+        count++;
+    }
+    qsort(data.nearest, count, sizeof(nearest_storage), compare_nearest);
+    for (int i = 0; i < count; i++) {
+        data.nearest_ids[i] = data.nearest[i].building_id;
+    }
+    *num_ids = count;
+    return data.nearest_ids;
+}
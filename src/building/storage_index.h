@@ -0,0 +1,40 @@
+#ifndef BUILDING_STORAGE_INDEX_H
+#define BUILDING_STORAGE_INDEX_H
+
+#include "building/building.h"
+
+/**
+ * @file
+ * Index of the warehouses and granaries in each road network, for finding the nearest storage building.
+ * It is rebuilt when used after the road networks were relabeled or the storage buildings changed.
+ */
+
+/**
+ * Marks the index as out of date, after a storage building was added or removed
+ * or the buildings were given their road network ids
+ */
+void building_storage_index_invalidate(void);
+
+/**
+ * Updates the resources stored in a warehouse, after the contents of one of its spaces changed
+ * @param warehouse The main warehouse building
+ */
+void building_storage_index_update_warehouse(building *warehouse);
+
+/**
+ * Gets the storage buildings of a type in a road network, nearest first.
+ * Distances are measured from the top left tile of a warehouse and the center tile of a granary.
+ * Buildings at the same distance are ordered by id.
+ * @param type BUILDING_WAREHOUSE or BUILDING_GRANARY
+ * @param road_network_id Road network of the buildings
+ * @param resource For warehouses: only include those storing this resource. RESOURCE_NONE to include all
+ * @param x X coordinate to measure the distance from
+ * @param y Y coordinate to measure the distance from
+ * @param num_ids OUT: the number of building ids
+ * @return The building ids, valid until the next call. If the index could not be allocated,
+ *         0 is returned and *num_ids is building_count(): then the caller checks every building id
+ */
+const int *building_storage_index_nearest(building_type type, int road_network_id, int resource,
+    int x, int y, int *num_ids);
+
+#endif // BUILDING_STORAGE_INDEX_H
@@ -7,6 +7,7 @@
 #include "building/monument.h"
 #include "building/model.h"
 #include "building/storage.h"
+#include "building/storage_index.h"
 #include "city/finance.h"
 #include "city/resource.h"
 #include "core/calc.h"
@@ -16,7 +17,56 @@
 #include "map/image.h"
 #include "scenario/property.h"
 
+#include <string.h>
+
 #define INFINITE 10000
+#define MAX_LOADS_PER_WAREHOUSE 32
+
+typedef struct {
+    int has_missing_space;
+    int empty_spaces;
+    int loads[RESOURCE_MAX];
+    int spaces[RESOURCE_MAX];
+    int spaces_with_room[RESOURCE_MAX]; // for RESOURCE_NONE: all spaces without a resource
+} warehouse_stock;
+
+static void get_stock(building *warehouse, warehouse_stock *stock)
+{
+    memset(stock, 0, sizeof(warehouse_stock));
+    building *space = warehouse;
+    for (int i = 0; i < 8; i++) {
+        space = building_next(space);
+        if (space->id <= 0) {
+            stock->has_missing_space = 1;
+        }
+        int resource = space->subtype.warehouse_resource_id;
+        if (resource < RESOURCE_NONE || resource >= RESOURCE_MAX) {
+            continue;
+        }
+        if (resource == RESOURCE_NONE || space->loads_stored < 4) {
+            stock->spaces_with_room[resource]++;
+        }
+        if (space->id <= 0) {
+            continue;
+        }
+        if (space->loads_stored <= 0) {
+            stock->empty_spaces++;
+        } else {
+            stock->loads[resource] += space->loads_stored;
+        }
+        stock->spaces[resource]++;
+    }
+}
+
+static int stock_amount(const warehouse_stock *stock, int resource)
+{
+    return stock->has_missing_space || resource == RESOURCE_NONE ? 0 : stock->loads[resource];
+}
+
+static int is_fully_staffed(building *b)
+{
+    return calc_percentage(b->num_workers, model_get_building(b->type)->laborers) >= 100;
+}
 
 int building_warehouse_get_space_info(building *warehouse)
 {
@@ -173,6 +223,8 @@ void building_warehouse_remove_resource_curse(building *warehouse, int amount)
 
 void building_warehouse_space_set_image(building *space, int resource)
 {
+    // Every change to the contents of a space ends here
+    building_storage_index_update_warehouse(building_main(space));
     int image_id;
     if (space->loads_stored <= 0) {
         image_id = image_group(GROUP_BUILDING_WAREHOUSE_STORAGE_EMPTY);
@@ -236,10 +288,8 @@ int THREEQ_WAREHOUSE = 24;
 int HALF_WAREHOUSE = 16;
 int QUARTER_WAREHOUSE = 8;
 
-int building_warehouse_is_accepting(int resource, building *b)
+static int is_accepting_amount(const building_storage *s, int resource, int amount)
 {
-    const building_storage *s = building_storage_get(b->storage_id);
-    int amount = building_warehouse_get_amount(b, resource);
     if ((s->resource_state[resource] == BUILDING_STORAGE_STATE_ACCEPTING) ||
         (s->resource_state[resource] == BUILDING_STORAGE_STATE_ACCEPTING_3QUARTERS && amount < THREEQ_WAREHOUSE) ||
         (s->resource_state[resource] == BUILDING_STORAGE_STATE_ACCEPTING_HALF && amount < HALF_WAREHOUSE) ||
@@ -250,10 +300,8 @@ int building_warehouse_is_accepting(int resource, building *b)
     }
 }
 
-int building_warehouse_is_getting(int resource, building *b)
+static int is_getting_amount(const building_storage *s, int resource, int amount)
 {
-    const building_storage *s = building_storage_get(b->storage_id);
-    int amount = building_warehouse_get_amount(b, resource);
     if ((s->resource_state[resource] == BUILDING_STORAGE_STATE_GETTING) ||
         (s->resource_state[resource] == BUILDING_STORAGE_STATE_GETTING_3QUARTERS && amount < THREEQ_WAREHOUSE) ||
         (s->resource_state[resource] == BUILDING_STORAGE_STATE_GETTING_HALF && amount < HALF_WAREHOUSE) ||
@@ -264,6 +312,18 @@ int building_warehouse_is_getting(int resource, building *b)
     }
 }
 
+int building_warehouse_is_accepting(int resource, building *b)
+{
+    const building_storage *s = building_storage_get(b->storage_id);
+    return is_accepting_amount(s, resource, building_warehouse_get_amount(b, resource));
+}
+
+int building_warehouse_is_getting(int resource, building *b)
+{
+    const building_storage *s = building_storage_get(b->storage_id);
+    return is_getting_amount(s, resource, building_warehouse_get_amount(b, resource));
+}
+
 int building_warehouse_is_gettable(int resource, building *b)
 {
     const building_storage *s = building_storage_get(b->storage_id);
@@ -277,9 +337,15 @@ int building_warehouse_is_gettable(int resource, building *b)
     }
 }
 
+static int is_not_accepting_amount(const building_storage *s, int resource, int amount)
+{
+    return !is_accepting_amount(s, resource, amount) && !is_getting_amount(s, resource, amount);
+}
+
 int building_warehouse_is_not_accepting(int resource, building *b)
 {
-    return !((building_warehouse_is_accepting(resource, b) || building_warehouse_is_getting(resource, b)));
+    const building_storage *s = building_storage_get(b->storage_id);
+    return is_not_accepting_amount(s, resource, building_warehouse_get_amount(b, resource));
 }
 
 int building_warehouse_get_acceptable_quantity(int resource, building *b)
@@ -349,25 +415,18 @@ int building_warehouse_accepts_storage(building *b, int resource, int *understaf
         return 0;
     }
     const building_storage *s = building_storage_get(b->storage_id);
-    if (building_warehouse_is_not_accepting(resource, b) || s->empty_all) {
+    warehouse_stock stock;
+    get_stock(b, &stock);
+    if (is_not_accepting_amount(s, resource, stock_amount(&stock, resource)) || s->empty_all) {
         return 0;
     }
-    int pct_workers = calc_percentage(b->num_workers, model_get_building(b->type)->laborers);
-    if (pct_workers < 100) {
+    if (!is_fully_staffed(b)) {
         if (understaffed) {
             *understaffed += 1;
         }
         return 0;
     }
-    building *space = b;
-    for (int t = 0; t < 8; t++) {
-        space = building_next(space);
-        if (space->subtype.warehouse_resource_id == RESOURCE_NONE || // empty warehouse space
-            (space->subtype.warehouse_resource_id == resource && space->loads_stored < 4)) {
-            return 1;
-        }
-    }
-    return 0;
+    return stock.spaces_with_room[RESOURCE_NONE] || stock.spaces_with_room[resource];
 }
 
 int building_warehouse_for_storing(int src_building_id, int x, int y, int resource, int road_network_id,
@@ -375,12 +434,25 @@ int building_warehouse_for_storing(int src_building_id, int x, int y, int resour
 {
     int min_dist = INFINITE;
     int min_building_id = 0;
-    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
-        if (b->id == src_building_id || b->road_network_id != road_network_id ||
-            !building_warehouse_accepts_storage(b, resource, understaffed)) {
+    int num_ids;
+    const int *ids = building_storage_index_nearest(BUILDING_WAREHOUSE, road_network_id, RESOURCE_NONE, x, y, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        building *b = building_get(ids ? ids[n] : n);
+        if (b->type != BUILDING_WAREHOUSE || b->id == src_building_id || b->road_network_id != road_network_id) {
             continue;
         }
         int dist = calc_maximum_distance(b->x, b->y, x, y);
+        // A warehouse that can't be closer only matters when it is counted as understaffed
+        if (dist >= min_dist && (!understaffed || is_fully_staffed(b))) {
+            if (ids && !understaffed) {
+                // Nearest first: none of the remaining warehouses is closer
+                break;
+            }
+            continue;
+        }
+        if (!building_warehouse_accepts_storage(b, resource, understaffed)) {
+            continue;
+        }
         if (dist < min_dist) {
             min_dist = dist;
             min_building_id = b->id;
@@ -421,9 +493,15 @@ int building_warehouse_for_getting(building *src, int resource, map_point *dst)
         if (b->id == src->id) {
             continue;
         }
+        if (building_warehouse_is_gettable(resource, b)) {
+            continue;
+        }
+        int dist = calc_maximum_distance(b->x, b->y, src->x, src->y);
+        if (dist - 4 * MAX_LOADS_PER_WAREHOUSE >= min_dist) {
+            continue;
+        }
         int loads_stored = building_warehouse_amount_can_get_from(b, resource);
-        if (loads_stored > 0 && !building_warehouse_is_gettable(resource, b)) {
-            int dist = calc_maximum_distance(b->x, b->y, src->x, src->y);
+        if (loads_stored > 0) {
             dist -= 4 * loads_stored;
             if (dist < min_dist) {
                 min_dist = dist;
@@ -447,21 +525,33 @@ int building_warehouse_with_resource(int src_building_id, int x, int y, int reso
 {
     int min_dist = INFINITE;
     building *min_building = 0;
-    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
-        if (b->state != BUILDING_STATE_IN_USE) {
+    // Counting the understaffed warehouses needs all of them, not only those storing the resource
+    int num_ids;
+    const int *ids = building_storage_index_nearest(BUILDING_WAREHOUSE, road_network_id,
+        understaffed ? RESOURCE_NONE : resource, x, y, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        building *b = building_get(ids ? ids[n] : n);
+        if (b->type != BUILDING_WAREHOUSE || b->state != BUILDING_STATE_IN_USE) {
             continue;
         }
         if (!b->has_road_access || b->distance_from_entry <= 0 || b->road_network_id != road_network_id) {
             continue;
         }
 
-        int pct_workers = calc_percentage(b->num_workers, model_get_building(b->type)->laborers);
-        if (pct_workers < 100) {
+        if (!is_fully_staffed(b)) {
             if (understaffed) {
                 *understaffed += 1;
             }
             continue;
         }
+        int dist = calc_maximum_distance(b->x, b->y, x, y);
+        if (dist - 4 * MAX_LOADS_PER_WAREHOUSE > min_dist) {
+            if (ids && !understaffed) {
+                // Nearest first: none of the remaining warehouses can be better
+                break;
+            }
+            continue;
+        }
         int loads_stored = 0;
         building *space = b;
         for (int t = 0; t < 8; t++) {
@@ -473,9 +563,9 @@ int building_warehouse_with_resource(int src_building_id, int x, int y, int reso
             }
         }
         if (loads_stored > 0) {
-            int dist = calc_maximum_distance(b->x, b->y, x, y);
             dist -= 4 * loads_stored;
-            if (dist < min_dist) {
+            // Warehouses are not checked by id, so the lowest id wins a tie explicitly
+            if (dist < min_dist || (dist == min_dist && min_building && b->id < min_building->id)) {
                 min_dist = dist;
                 min_building = b;
             }
@@ -581,34 +671,15 @@ int building_warehouse_determine_worker_task(building *warehouse, int *resource)
     }
     const building_storage *s = building_storage_get(warehouse->storage_id);
     building *space;
+    warehouse_stock stock;
+    get_stock(warehouse, &stock);
     // get resources
     for (int r = RESOURCE_MIN; r < RESOURCE_MAX; r++) {
-        if (!building_warehouse_is_getting(r, warehouse) || city_resource_is_stockpiled(r)) {
+        if (!is_getting_amount(s, r, stock_amount(&stock, r)) || city_resource_is_stockpiled(r)) {
             continue;
         }
-        int loads_stored = 0;
-        space = warehouse;
-        for (int i = 0; i < 8; i++) {
-            space = building_next(space);
-            if (space->id > 0 && space->loads_stored > 0) {
-                if (space->subtype.warehouse_resource_id == r) {
-                    loads_stored += space->loads_stored;
-                }
-            }
-        }
-        int room = 0;
-        space = warehouse;
-        for (int i = 0; i < 8; i++) {
-            space = building_next(space);
-            if (space->id > 0) {
-                if (space->loads_stored <= 0) {
-                    room += 4;
-                }
-                if (space->subtype.warehouse_resource_id == r) {
-                    room += 4 - space->loads_stored;
-                }
-            }
-        }
+        int loads_stored = stock.loads[r];
+        int room = 4 * (stock.empty_spaces + stock.spaces[r]) - loads_stored;
         if (room >= 4 && (loads_stored <= 4 || ((building_warehouse_get_acceptable_quantity(r, warehouse) - loads_stored) >= 4)) && city_resource_count(r) - loads_stored >= 4) {
             if (!building_warehouse_for_getting(warehouse, r, 0)) {
                 continue;
@@ -68,6 +68,8 @@ void city_warning_show(warning_type type)
         text = translation_for(TR_WARNING_BET_VICTORY);
     } else if (type == WARNING_BET_DEFEAT) {
         text = translation_for(TR_WARNING_BET_DEFEAT);
+    } else if (type == WARNING_AUTOSAVE_FAILED) {
+        text = translation_for(TR_WARNING_AUTOSAVE_FAILED);
     } else {
         text = lang_get_string(19, type - 2);
     }
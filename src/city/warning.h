@@ -68,7 +68,8 @@ typedef enum {
     WARNING_THEFT = 74,
     WARNING_WOLF_NEARBY = 75,
     WARNING_BET_VICTORY = 76,
-    WARNING_BET_DEFEAT = 77
+    WARNING_BET_DEFEAT = 77,
+    WARNING_AUTOSAVE_FAILED = 78
 } warning_type;
 
 void city_warning_show(warning_type type);
@@ -15,6 +15,9 @@ struct { \
     int blocks; \
     int block_offset; \
     int bit_offset; \
+    int track_free_slots; \
+    int free_slot_start; \
+    int first_free_slot; \
     void (*constructor)(T *, int); \
     int (*in_use)(const T *); \
 }
@@ -44,6 +47,28 @@ struct { \
     array_create_blocks(a, 1) \
 )
 
+/**
+ * Enables free slot tracking for an array. The array then remembers up to where all items are in use,
+ * so array_new_item does not have to check every item from the start index again.
+ * The returned items are exactly the same as without tracking, as long as array_release_item
+ * is called every time an item stops being in use.
+ * @param a The array structure
+ */
+#define array_enable_free_slot_tracking(a) \
+    ( (a).track_free_slots = 1 )
+
+/**
+ * Tells the array that an item is no longer in use. Only needed when free slot tracking is enabled.
+ * @param a The array structure
+ * @param position The position of the item that was released
+ */
+#define array_release_item(a, position) \
+{ \
+    if ((position) < (a).first_free_slot) { \
+        (a).first_free_slot = (position); \
+    } \
+}
+
 /**
  * Creates a new item for the array, either by finding an available empty item or by expanding the array.
  * @param a The array structure
@@ -61,20 +86,29 @@ struct { \
             break; \
         } \
     } \
+    int search_start = index; \
+    if ((a).track_free_slots) { \
+        if ((a).free_slot_start == index && (a).first_free_slot > index) { \
+            search_start = (a).first_free_slot; \
+        } \
+        (a).free_slot_start = index; \
+    } \
     if (!error && (a).in_use) { \
-        for (int i = index; i < (a).size; i++) { \
+        for (int i = search_start; i < (a).size; i++) { \
             if (!(a).in_use(array_item(a, i))) { \
                 ptr = array_item(a, i); \
                 memset(ptr, 0, sizeof(**(a).items)); \
                 if ((a).constructor) { \
                     (a).constructor(ptr, i); \
                 } \
+                (a).first_free_slot = i; \
                 break; \
             } \
         } \
     } \
     if (!error && !ptr) { \
         ptr = array_advance(a); \
+        (a).first_free_slot = (a).size - 1; \
     } \
 }
 
@@ -137,6 +171,9 @@ struct { \
             (a).size--; \
         } \
     } \
+    if ((a).first_free_slot > (a).size) { \
+        (a).first_free_slot = (a).size; \
+    } \
 }
 
 /**
@@ -56,6 +56,7 @@ static const char *ini_keys[] = {
     "gameplay_change_monuments_boost_culture_rating",
     "gameplay_change_disable_infinite_wolves_spawning",
     "gameplay_change_romers_dont_skip_corners",
+    "gameplay_deterministic_routing",
 };
 
 static const char *ini_string_keys[] = {
@@ -78,7 +79,8 @@ static int default_values[CONFIG_MAX_ENTRIES] = {
     [CONFIG_UI_HIGHLIGHT_LEGIONS] = 1,
     [CONFIG_SCREEN_DISPLAY_SCALE] = 100,
     [CONFIG_SCREEN_CURSOR_SCALE] = 100,
-    [CONFIG_GP_CH_MAX_GRAND_TEMPLES] = 2
+    [CONFIG_GP_CH_MAX_GRAND_TEMPLES] = 2,
+    [CONFIG_GP_DETERMINISTIC_ROUTING] = 1
 };
 
 static const char default_string_values[CONFIG_STRING_MAX_ENTRIES][CONFIG_STRING_VALUE_MAX];
@@ -48,6 +48,7 @@ typedef enum {
     CONFIG_GP_CH_MONUMENTS_BOOST_CULTURE_RATING,
     CONFIG_GP_CH_DISABLE_INFINITE_WOLVES_SPAWNING,
     CONFIG_GP_CH_ROAMERS_DONT_SKIP_CORNERS,
+    CONFIG_GP_DETERMINISTIC_ROUTING,
     CONFIG_MAX_ENTRIES
 } config_key;
 
@@ -9,13 +9,102 @@
 #include <string.h>
 
 #define BASE_MAX_FILES 100
+#define CACHE_BUCKETS 1024
+#define MAX_CACHED_FILES 4096
+
+typedef struct cached_file {
+    char *dir;
+    char *filepath;
+    char *corrected; // 0 when the file was not found
+    struct cached_file *next;
+} cached_file;
 
 static struct {
     dir_listing listing;
     int max_files;
     char *cased_filename;
+    struct {
+        cached_file *buckets[CACHE_BUCKETS];
+        int num_files;
+        char corrected[2 * FILE_NAME_MAX];
+    } cache;
 } data;
 
+static char *copy_string(const char *str)
+{
+    size_t length = strlen(str) + 1;
+    char *copy = malloc(length);
+    if (copy) {
+        memcpy(copy, str, length);
+    }
+    return copy;
+}
+
+static unsigned int cache_bucket(const char *dir, const char *filepath)
+{
+    unsigned int hash = 5381;
+    for (const char *c = dir; *c; c++) {
+        hash = hash * 33 + (unsigned char) *c;
+    }
+    hash = hash * 33 + '/';
+    for (const char *c = filepath; *c; c++) {
+        hash = hash * 33 + (unsigned char) *c;
+    }
+    return hash % CACHE_BUCKETS;
+}
+
+void dir_clear_cache(void)
+{
+    for (int i = 0; i < CACHE_BUCKETS; i++) {
+        cached_file *file = data.cache.buckets[i];
+        while (file) {
+            cached_file *next = file->next;
+            free(file->dir);
+            free(file->filepath);
+            free(file->corrected);
+            free(file);
+            file = next;
+        }
+        data.cache.buckets[i] = 0;
+    }
+    data.cache.num_files = 0;
+}
+
+static cached_file *find_cached_file(const char *dir, const char *filepath)
+{
+    for (cached_file *file = data.cache.buckets[cache_bucket(dir, filepath)]; file; file = file->next) {
+        if (strcmp(file->filepath, filepath) == 0 && strcmp(file->dir, dir) == 0) {
+            return file;
+        }
+    }
+    return 0;
+}
+
+static void add_cached_file(const char *dir, const char *filepath, const char *corrected)
+{
+    if (data.cache.num_files >= MAX_CACHED_FILES) {
+        dir_clear_cache();
+    }
+    cached_file *file = malloc(sizeof(cached_file));
+    if (!file) {
+        return;
+    }
+    file->dir = copy_string(dir);
+    file->filepath = copy_string(filepath);
+    file->corrected = corrected ? copy_string(corrected) : 0;
+    if (!file->dir || !file->filepath || (corrected && !file->corrected)) {
+        free(file->dir);
+        free(file->filepath);
+        free(file->corrected);
+        free(file);
+        return;
+    }
+    unsigned int bucket = cache_bucket(dir, filepath);
+    file->next = data.cache.buckets[bucket];
+    data.cache.buckets[bucket] = file;
+    data.cache.num_files++;
+}
+
 static void allocate_listing_files(int min, int max)
 {
     for (int i = min; i < max; i++) {
@@ -66,6 +155,8 @@ static int add_to_listing(const char *filename)
 
 const dir_listing *dir_find_files_with_extension(const char *dir, const char *extension)
 {
+    // Files may have been added or removed outside the game
+    dir_clear_cache();
     clear_dir_listing();
     platform_file_manager_list_directory_contents(dir, TYPE_FILE, extension, add_to_listing);
     qsort(data.listing.files, data.listing.num_files, sizeof(char *), compare_lower);
@@ -74,6 +165,8 @@ const dir_listing *dir_find_files_with_extension(const char *dir, const char *ex
 
 const dir_listing *dir_find_all_subdirectories(void)
 {
+    // Files may have been added or removed outside the game
+    dir_clear_cache();
     clear_dir_listing();
     platform_file_manager_list_directory_contents(0, TYPE_DIR, 0, add_to_listing);
     qsort(data.listing.files, data.listing.num_files, sizeof(char *), compare_lower);
@@ -104,7 +197,7 @@ static void move_left(char *str)
     *str = 0;
 }
 
-static const char *get_case_corrected_file(const char *dir, const char *filepath)
+static const char *correct_file_case(const char *dir, const char *filepath)
 {
     static char corrected_filename[2 * FILE_NAME_MAX];
     corrected_filename[2 * FILE_NAME_MAX - 1] = 0;
@@ -166,6 +259,25 @@ static const char *get_case_corrected_file(const char *dir, const char *filepath
     return corrected_filename + dir_skip;
 }
 
+static const char *get_case_corrected_file(const char *dir, const char *filepath)
+{
+    if (!dir) {
+        dir = "";
+    }
+    cached_file *file = find_cached_file(dir, filepath);
+    if (file) {
+        if (!file->corrected) {
+            return 0;
+        }
+        // Copied, so the cache can be cleared while the caller still uses the filename
+        strcpy(data.cache.corrected, file->corrected);
+        return data.cache.corrected;
+    }
+    const char *corrected = correct_file_case(dir, filepath);
+    add_cached_file(dir, filepath, corrected);
+    return corrected;
+}
+
 const dir_listing *dir_append_files_with_extension(const char *extension)
 {
     platform_file_manager_list_directory_contents(0, TYPE_FILE, extension, add_to_listing);
@@ -52,4 +52,10 @@ const char *dir_get_file(const char *filepath, int localizable);
  */
 const char *dir_get_asset(const char *asset_path, const char *filepath);
 
+/**
+ * Forgets the files found or not found by dir_get_file and dir_get_asset.
+ * Needs to be called when files are created or removed.
+ */
+void dir_clear_cache(void);
+
 #endif // CORE_DIR_H
@@ -1,14 +1,20 @@
 #include "core/file.h"
 
+#include "core/dir.h"
 #include "core/string.h"
 #include "platform/file_manager.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 FILE *file_open(const char *filename, const char *mode)
 {
-    return platform_file_manager_open_file(filename, mode);
+    FILE *fp = platform_file_manager_open_file(filename, mode);
+    if (fp && (strchr(mode, 'w') || strchr(mode, 'a'))) {
+        dir_clear_cache();
+    }
+    return fp;
 }
 
 FILE *file_open_asset(const char *asset, const char *mode)
@@ -87,5 +93,19 @@ int file_exists(const char *filename, int localizable)
 
 int file_remove(const char *filename)
 {
-    return platform_file_manager_remove_file(filename);
+    int result = platform_file_manager_remove_file(filename);
+    dir_clear_cache();
+    return result;
+}
+
+int file_can_rename(void)
+{
+    return platform_file_manager_can_rename_file();
+}
+
+int file_rename(const char *filename, const char *new_filename)
+{
+    int result = platform_file_manager_rename_file(filename, new_filename);
+    dir_clear_cache();
+    return result;
 }
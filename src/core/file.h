@@ -85,4 +85,18 @@ int file_exists(const char *filename, int localizable);
  */
 int file_remove(const char *filename);
 
+/**
+ * Checks whether files can be renamed on this platform
+ * @return boolean true if file_rename is supported, false otherwise
+ */
+int file_can_rename(void);
+
+/**
+ * Rename a file, replacing the file with the new name if it exists
+ * @param filename Filename to rename
+ * @param new_filename New filename
+ * @return boolean true if the file was renamed, false otherwise
+ */
+int file_rename(const char *filename, const char *new_filename);
+
 #endif // CORE_FILE_H
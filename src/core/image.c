@@ -34,6 +34,9 @@
 
 #define CYRILLIC_FONT_BASE_OFFSET 201
 
+#define MAX_CACHED_EXTERNAL_IMAGES 16
+#define EXTERNAL_CACHE_MEMORY_LIMIT (24 * 1024 * 1024)
+
 #define NAME_SIZE 32
 
 enum {
@@ -118,6 +121,13 @@ static const char ENEMY_GRAPHICS_555[][NAME_SIZE] = {
 
 static const image DUMMY_IMAGE;
 
+typedef struct {
+    int image_id;
+    int size;
+    unsigned int last_used;
+    color_t *pixels;
+} external_image;
+
 static struct {
     int current_climate;
     int is_editor;
@@ -133,7 +143,15 @@ static struct {
     color_t *empire_data;
     color_t *enemy_data;
     color_t *font_data;
+    int *main_row_offsets;
+    int *enemy_row_offsets;
+    int *font_row_offsets;
     uint8_t *tmp_data;
+    struct {
+        external_image images[MAX_CACHED_EXTERNAL_IMAGES];
+        int memory_used;
+        unsigned int use_counter;
+    } external;
 } data = {.current_climate = -1};
 
 int image_init(void)
@@ -152,6 +170,82 @@ int image_init(void)
     return 1;
 }
 
+static void remove_external_image(external_image *cached)
+{
+    data.external.memory_used -= cached->size;
+    free(cached->pixels);
+    cached->pixels = 0;
+    cached->size = 0;
+}
+
+static void clear_external_images(void)
+{
+    for (int i = 0; i < MAX_CACHED_EXTERNAL_IMAGES; i++) {
+        if (data.external.images[i].pixels) {
+            remove_external_image(&data.external.images[i]);
+        }
+    }
+}
+
+static const color_t *get_cached_external_image(int image_id)
+{
+    for (int i = 0; i < MAX_CACHED_EXTERNAL_IMAGES; i++) {
+        external_image *cached = &data.external.images[i];
+        if (cached->pixels && cached->image_id == image_id) {
+            cached->last_used = ++data.external.use_counter;
+            return cached->pixels;
+        }
+    }
+    return 0;
+}
+
+static external_image *least_recently_used_external_image(void)
+{
+    external_image *oldest = 0;
+    for (int i = 0; i < MAX_CACHED_EXTERNAL_IMAGES; i++) {
+        external_image *cached = &data.external.images[i];
+        if (cached->pixels && (!oldest || cached->last_used < oldest->last_used)) {
+            oldest = cached;
+        }
+    }
+    return oldest;
+}
+
+static external_image *free_external_image(void)
+{
+    for (int i = 0; i < MAX_CACHED_EXTERNAL_IMAGES; i++) {
+        if (!data.external.images[i].pixels) {
+            return &data.external.images[i];
+        }
+    }
+    external_image *oldest = least_recently_used_external_image();
+    remove_external_image(oldest);
+    return oldest;
+}
+
+// Keeps a copy of the decoded pixels, so the file does not have to be read again on the next frame
+static const color_t *cache_external_image(int image_id, const color_t *pixels, int length)
+{
+    int size = length * sizeof(color_t);
+    if (size > EXTERNAL_CACHE_MEMORY_LIMIT) {
+        return pixels;
+    }
+    while (data.external.memory_used + size > EXTERNAL_CACHE_MEMORY_LIMIT) {
+        remove_external_image(least_recently_used_external_image());
+    }
+    external_image *cached = free_external_image();
+    cached->pixels = malloc(size);
+    if (!cached->pixels) {
+        return pixels;
+    }
+    memcpy(cached->pixels, pixels, size);
+    cached->image_id = image_id;
+    cached->size = size;
+    cached->last_used = ++data.external.use_counter;
+    data.external.memory_used += size;
+    return cached->pixels;
+}
+
 static void prepare_index(image *images, int size)
 {
     int offset = 4;
@@ -193,6 +287,7 @@ static void read_index_entry(buffer *buf, image *img)
     buffer_skip(buf, 1);
     img->animation_speed_id = buffer_read_u8(buf);
     buffer_skip(buf, 5);
+    img->draw.row_offsets = 0;
 }
 
 static void read_index(buffer *buf, image *images, int size)
@@ -253,8 +348,47 @@ static int convert_compressed(buffer *buf, int buf_length, color_t *dst)
     return dst_length;
 }
 
-static void convert_images(image *images, int size, buffer *buf, color_t *dst)
+static void index_compressed_rows(image *img, const color_t *pixels, int length, int *row_offsets)
 {
+    int offset = 0;
+    int row = 0;
+    while (row < img->height && offset < length) {
+        row_offsets[row++] = offset;
+        int x = 0;
+        while (x < img->width && offset < length) {
+            color_t control = pixels[offset++];
+            if (control == 255) {
+                x += pixels[offset++];
+            } else {
+                x += control;
+                offset += control;
+            }
+        }
+    }
+    while (row < img->height) {
+        row_offsets[row++] = length;
+    }
+    img->draw.row_offsets = row_offsets;
+}
+
+/**
+ * Converts the images to 32-bit colors, and indexes the start of each row of the compressed images
+ * so that clipped images can be drawn from their first visible row.
+ * The index is left out when it cannot be allocated.
+ */
+static void convert_images(image *images, int size, buffer *buf, color_t *dst, int **row_offsets)
+{
+    int total_rows = 0;
+    for (int i = 0; i < size; i++) {
+        const image *img = &images[i];
+        if (!img->draw.is_external && (img->draw.is_fully_compressed || img->draw.has_compressed_part)) {
+            total_rows += img->height;
+        }
+    }
+    free(*row_offsets);
+    *row_offsets = total_rows ? (int *) malloc(total_rows * sizeof(int)) : 0;
+    int *next_row_offsets = *row_offsets;
+
     color_t *start_dst = dst;
     dst++; // make sure img->offset > 0
     for (int i = 0; i < size; i++) {
@@ -264,14 +398,23 @@ static void convert_images(image *images, int size, buffer *buf, color_t *dst)
         }
         buffer_set(buf, img->draw.offset);
         int img_offset = (int) (dst - start_dst);
+        const color_t *compressed = dst;
+        int compressed_length = -1;
         if (img->draw.is_fully_compressed) {
-            dst += convert_compressed(buf, img->draw.data_length, dst);
+            compressed_length = convert_compressed(buf, img->draw.data_length, dst);
+            dst += compressed_length;
         } else if (img->draw.has_compressed_part) { // isometric tile
             dst += convert_uncompressed(buf, img->draw.uncompressed_length, dst);
-            dst += convert_compressed(buf, img->draw.data_length - img->draw.uncompressed_length, dst);
+            compressed = dst;
+            compressed_length = convert_compressed(buf, img->draw.data_length - img->draw.uncompressed_length, dst);
+            dst += compressed_length;
         } else {
             dst += convert_uncompressed(buf, img->draw.data_length, dst);
         }
+        if (compressed_length >= 0 && next_row_offsets) {
+            index_compressed_rows(img, compressed, compressed_length, next_row_offsets);
+            next_row_offsets += img->height;
+        }
         img->draw.offset = img_offset;
         img->draw.uncompressed_length /= 2;
     }
@@ -307,13 +450,14 @@ int image_load_climate(int climate_id, int is_editor, int force_reload)
     read_header(&buf);
     buffer_init(&buf, &data.tmp_data[HEADER_SIZE], ENTRY_SIZE * MAIN_ENTRIES);
     read_index(&buf, data.main, MAIN_ENTRIES);
+    clear_external_images();
 
     int data_size = io_read_file_into_buffer(filename_bmp, MAY_BE_LOCALIZED, data.tmp_data, SCRATCH_DATA_SIZE);
     if (!data_size) {
         return 0;
     }
     buffer_init(&buf, data.tmp_data, data_size);
-    convert_images(data.main, MAIN_ENTRIES, &buf, data.main_data);
+    convert_images(data.main, MAIN_ENTRIES, &buf, data.main_data, &data.main_row_offsets);
     data.current_climate = climate_id;
     data.is_editor = is_editor;
 
@@ -325,8 +469,10 @@ static void free_font_memory(void)
 {
     free(data.font);
     free(data.font_data);
+    free(data.font_row_offsets);
     data.font = 0;
     data.font_data = 0;
+    data.font_row_offsets = 0;
     data.fonts_enabled = NO_EXTRA_FONT;
 }
 
@@ -362,7 +508,7 @@ static int load_cyrillic_fonts(void)
         return 0;
     }
     buffer_init(&buf, data.tmp_data, data_size);
-    convert_images(data.font, CYRILLIC_FONT_ENTRIES, &buf, data.font_data);
+    convert_images(data.font, CYRILLIC_FONT_ENTRIES, &buf, data.font_data, &data.font_row_offsets);
 
     data.fonts_enabled = FULL_CHARSET_IN_FONT;
     data.font_base_offset = CYRILLIC_FONT_BASE_OFFSET;
@@ -639,12 +785,16 @@ int image_load_enemy(int enemy_id)
         return 0;
     }
     buffer_init(&buf, data.tmp_data, data_size);
-    convert_images(data.enemy, ENEMY_ENTRIES, &buf, data.enemy_data);
+    convert_images(data.enemy, ENEMY_ENTRIES, &buf, data.enemy_data, &data.enemy_row_offsets);
     return 1;
 }
 
 static const color_t *load_external_data(int image_id)
 {
+    const color_t *cached_pixels = get_cached_external_image(image_id);
+    if (cached_pixels) {
+        return cached_pixels;
+    }
     image *img = &data.main[image_id];
     char filename[FILE_NAME_MAX] = "555/";
     strcpy(&filename[4], data.bitmaps[img->draw.bitmap_id]);
@@ -669,12 +819,13 @@ static const color_t *load_external_data(int image_id)
     buffer_init(&buf, data.tmp_data, size);
     color_t *dst = (color_t*) &data.tmp_data[4000000];
     // NB: isometric images are never external
+    int length;
     if (img->draw.is_fully_compressed) {
-        convert_compressed(&buf, img->draw.data_length, dst);
+        length = convert_compressed(&buf, img->draw.data_length, dst);
     } else {
-        convert_uncompressed(&buf, img->draw.data_length, dst);
+        length = convert_uncompressed(&buf, img->draw.data_length, dst);
     }
-    return dst;
+    return cache_external_image(image_id, dst, length);
 }
 
 int image_group(int group)
@@ -44,6 +44,7 @@ typedef struct {
         int offset;
         int data_length;
         int uncompressed_length;
+        const int *row_offsets;
     } draw;
 } image;
 
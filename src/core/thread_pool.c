@@ -0,0 +1,72 @@
+#include "core/thread_pool.h"
+
+static struct {
+    thread_pool_runner runner;
+    int num_threads;
+    int running;
+    thread_pool_background_starter background_starter;
+    thread_pool_background_waiter background_waiter;
+    thread_pool_background_checker background_checker;
+} data;
+
+void thread_pool_set_runner(thread_pool_runner runner, int num_threads)
+{
+    if (!runner || num_threads < 2) {
+        runner = 0;
+        num_threads = 1;
+    }
+    data.runner = runner;
+    data.num_threads = num_threads;
+}
+
+int thread_pool_num_threads(void)
+{
+    return data.runner ? data.num_threads : 1;
+}
+
+void thread_pool_run(thread_pool_task task, int num_tasks, void *userdata)
+{
+    // Tasks that run tasks themselves do so on their own thread
+    if (!data.runner || num_tasks < 2 || data.running) {
+        for (int i = 0; i < num_tasks; i++) {
+            task(i, userdata);
+        }
+        return;
+    }
+    data.running = 1;
+    data.runner(task, num_tasks, userdata);
+    data.running = 0;
+}
+
+void thread_pool_set_background_runner(thread_pool_background_starter starter,
+    thread_pool_background_waiter waiter, thread_pool_background_checker checker)
+{
+    if (!starter || !waiter || !checker) {
+        starter = 0;
+        waiter = 0;
+        checker = 0;
+    }
+    data.background_starter = starter;
+    data.background_waiter = waiter;
+    data.background_checker = checker;
+}
+
+void thread_pool_run_in_background(thread_pool_background_task task, void *userdata)
+{
+    thread_pool_wait_for_background();
+    if (!data.background_starter || !data.background_starter(task, userdata)) {
+        task(userdata);
+    }
+}
+
+void thread_pool_wait_for_background(void)
+{
+    if (data.background_waiter) {
+        data.background_waiter();
+    }
+}
+
+int thread_pool_background_is_running(void)
+{
+    return data.background_checker && data.background_checker();
+}
@@ -0,0 +1,115 @@
+#ifndef CORE_THREAD_POOL_H
+#define CORE_THREAD_POOL_H
+
+/**
+ * @file
+ * Running independent tasks on worker threads.
+ * The platform provides the threads. Without them, or with only one core, all tasks run on the calling thread.
+ */
+
+/**
+ * Storage class for variables that every thread has its own copy of.
+ * THREAD_POOL_HAS_THREAD_LOCAL is not defined when the compiler offers no such storage,
+ * in which case state used by tasks cannot be kept per thread.
+ */
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#define THREAD_POOL_HAS_THREAD_LOCAL
+#elif defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#define THREAD_POOL_HAS_THREAD_LOCAL
+#else
+#define THREAD_LOCAL
+#endif
+
+/**
+ * A task to run
+ * @param index Index of the task, from 0 to the number of tasks - 1
+ * @param userdata Data passed to thread_pool_run
+ */
+typedef void (*thread_pool_task)(int index, void *userdata);
+
+/**
+ * Runs the tasks and waits for all of them to finish
+ * @param task Task function, called once for every index in any order and possibly at the same time
+ * @param num_tasks Number of tasks
+ * @param userdata Data passed to every task
+ */
+typedef void (*thread_pool_runner)(thread_pool_task task, int num_tasks, void *userdata);
+
+/**
+ * Sets the function that runs tasks on worker threads
+ * @param runner Runner, or 0 to run all tasks on the calling thread
+ * @param num_threads Number of threads the runner uses, including the calling thread
+ */
+void thread_pool_set_runner(thread_pool_runner runner, int num_threads);
+
+/**
+ * @return Number of threads tasks can run on, 1 if they all run on the calling thread
+ */
+int thread_pool_num_threads(void);
+
+/**
+ * Runs the tasks and waits for all of them to finish.
+ * Tasks must not depend on each other: they can run in any order and at the same time.
+ * @param task Task function, called once for every index
+ * @param num_tasks Number of tasks
+ * @param userdata Data passed to every task
+ */
+void thread_pool_run(thread_pool_task task, int num_tasks, void *userdata);
+
+/**
+ * A task to run in the background
+ * @param userdata Data passed to thread_pool_run_in_background
+ */
+typedef void (*thread_pool_background_task)(void *userdata);
+
+/**
+ * Starts a task on a background thread and returns without waiting for it
+ * @param task Task function
+ * @param userdata Data passed to the task
+ * @return 1 if the task was started, 0 if it could not be
+ */
+typedef int (*thread_pool_background_starter)(thread_pool_background_task task, void *userdata);
+
+/**
+ * Waits until the background task has finished
+ */
+typedef void (*thread_pool_background_waiter)(void);
+
+/**
+ * Checks whether the background task is still running, without waiting for it
+ * @return 1 if the started task is still running, 0 otherwise
+ */
+typedef int (*thread_pool_background_checker)(void);
+
+/**
+ * Sets the functions that run a task on a background thread
+ * @param starter Starter, or 0 to run background tasks on the calling thread
+ * @param waiter Waiter for the started task
+ * @param checker Checker for the started task
+ */
+void thread_pool_set_background_runner(thread_pool_background_starter starter,
+    thread_pool_background_waiter waiter, thread_pool_background_checker checker);
+
+/**
+ * Runs a task on a background thread. Only one background task runs at a time:
+ * waits for the previous one to finish first.
+ * Without a background thread, the task runs on the calling thread before returning.
+ * @param task Task function
+ * @param userdata Data passed to the task
+ */
+void thread_pool_run_in_background(thread_pool_background_task task, void *userdata);
+
+/**
+ * Waits until the background task, if any, has finished
+ */
+void thread_pool_wait_for_background(void);
+
+/**
+ * Checks whether a background task is still running
+ * @return 1 if a background task is running, 0 if it finished or none was started
+ */
+int thread_pool_background_is_running(void);
+
+#endif // CORE_THREAD_POOL_H
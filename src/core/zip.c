@@ -6,6 +6,11 @@
 
 #include "core/log.h"
 
+#include "zlib.h"
+
+// zlib's default level: compresses saved games better than implode, at a fraction of the time
+#define DEFLATE_LEVEL 6
+
 enum {
     PK_SUCCESS = 0,
     PK_INVALID_WINDOWSIZE = 1,
@@ -772,3 +777,48 @@ int zip_decompress(const void *input_buffer, int input_length,
     free(buf);
     return ok;
 }
+
+int zip_deflate(const void *input_buffer, int input_length, void *output_buffer, int *output_length)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    if (deflateInit(&stream, DEFLATE_LEVEL) != Z_OK) {
+        log_error("COMP Unable to initialize deflate.", 0, 0);
+        return 0;
+    }
+    stream.next_in = (Bytef *) input_buffer;
+    stream.avail_in = (uInt) input_length;
+    stream.next_out = (Bytef *) output_buffer;
+    stream.avail_out = (uInt) *output_length;
+
+    // Running out of output space is not an error: the caller stores the data uncompressed
+    int ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+    if (ok) {
+        *output_length = (int) stream.total_out;
+    }
+    deflateEnd(&stream);
+    return ok;
+}
+
+int zip_inflate(const void *input_buffer, int input_length, void *output_buffer, int *output_length)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    if (inflateInit(&stream) != Z_OK) {
+        log_error("COMP Unable to initialize inflate.", 0, 0);
+        return 0;
+    }
+    stream.next_in = (Bytef *) input_buffer;
+    stream.avail_in = (uInt) input_length;
+    stream.next_out = (Bytef *) output_buffer;
+    stream.avail_out = (uInt) *output_length;
+
+    int ok = inflate(&stream, Z_FINISH) == Z_STREAM_END;
+    if (ok) {
+        *output_length = (int) stream.total_out;
+    } else {
+        log_error("COMP Error inflating.", 0, 0);
+    }
+    inflateEnd(&stream);
+    return ok;
+}
@@ -26,4 +26,24 @@ int zip_compress(const void *input_buffer, int input_length, void *output_buffer
  */
 int zip_decompress(const void *input_buffer, int input_length, void *output_buffer, int *output_length);
 
+/**
+ * Compresses the input buffer using zlib deflate, which is much faster than zip_compress
+ * @param input_buffer Input buffer to compress
+ * @param input_length Length of input buffer
+ * @param output_buffer Output buffer to write the compressed data to
+ * @param output_length IN: available length of the output buffer, OUT: written bytes
+ * @return boolean true on success, false on error
+ */
+int zip_deflate(const void *input_buffer, int input_length, void *output_buffer, int *output_length);
+
+/**
+ * Decompresses an input buffer compressed with zip_deflate
+ * @param input_buffer Input buffer to decompress
+ * @param input_length Length of the input buffer
+ * @param output_buffer Output buffer to write decompressed data to
+ * @param output_length IN: available length of the output buffer, OUT: written bytes
+ * @return boolean true on success, false on error
+ */
+int zip_inflate(const void *input_buffer, int input_length, void *output_buffer, int *output_length);
+
 #endif // CORE_ZIP_H
@@ -3,6 +3,7 @@
 #include "city/entertainment.h"
 #include "city/figures.h"
 #include "figure/figure.h"
+#include "figure/route.h"
 #include "figuretype/animal.h"
 #include "figuretype/cartpusher.h"
 #include "figuretype/crime.h"
@@ -21,6 +22,7 @@
 #include "figuretype/wall.h"
 #include "figuretype/water.h"
 #include "figuretype/workcamp.h"
+#include "game/profiler.h"
 
 
 static void figure_nobody_action(figure *f)
@@ -123,6 +125,7 @@ void figure_action_handle(void)
 {
     city_figures_reset();
     city_entertainment_set_hippodrome_has_race(0);
+    figure_route_find_expected();
     for (int i = 1; i < figure_count(); i++) {
         figure *f = figure_get(i);
         if (f->state) {
@@ -135,7 +138,10 @@ void figure_action_handle(void)
                     f->targeted_by_figure_id = 0;
                 }
             }
+            int section = PROFILER_SECTION_FIGURE_TYPE + f->type;
+            profiler_start(section);
             figure_action_callbacks[f->type](f);
+            profiler_stop(section);
             if (f->state == FIGURE_STATE_DEAD) {
                 figure_delete(f);
             }
@@ -159,6 +159,7 @@ void figure_delete(figure *f)
     memset(f, 0, sizeof(figure));
     f->id = figure_id;
 
+    array_release_item(data.figures, figure_id);
     array_trim(data.figures);
 }
 
@@ -198,6 +199,7 @@ void figure_init_scenario(void)
         !array_next(data.figures)) { // Ignore first figure
         log_error("Unable to create figures array. The game will now crash.", 0, 0);
     }
+    array_enable_free_slot_tracking(data.figures);
     data.created_sequence = 0;
 }
 
@@ -473,6 +475,7 @@ void figure_load_state(buffer *list, buffer *seq, int includes_figure_size)
         !array_expand(data.figures, figures_to_load)) {
         log_error("Unable to create figures array. The game will now crash.", 0, 0);
     }
+    array_enable_free_slot_tracking(data.figures);
 
     int highest_id_in_use = 0;
 
@@ -2,19 +2,158 @@
 
 #include "core/array.h"
 #include "core/log.h"
+#include "core/thread_pool.h"
+#include "map/grid.h"
 #include "map/routing.h"
 #include "map/routing_path.h"
+#include "map/routing_terrain.h"
+
+#include <stdlib.h>
+#include <string.h>
 
 #define ARRAY_SIZE_STEP 600
+#define LONG_PATHS_ARRAY_SIZE_STEP 100
 #define MAX_PATH_LENGTH 500
+#define SHORT_PATH_LENGTH 40
+#define ROUTE_CACHE_SIZE 64
+#define MAX_EXPECTED_ROUTES (ROUTE_CACHE_SIZE / 2)
+
+// Directions take 3 bits each. One extra byte allows reading any direction as two bytes.
+#define PACKED_DIRECTIONS_SIZE(length) (((length) * 3 + 7) / 8 + 1)
 
 typedef struct {
     int id;
     int figure_id;
-    uint8_t directions[MAX_PATH_LENGTH];
+    int length;
+    int long_path_id;
+    uint8_t directions[PACKED_DIRECTIONS_SIZE(SHORT_PATH_LENGTH)];
 } figure_path_data;
 
+typedef struct {
+    int id;
+    int in_use;
+    uint8_t directions[PACKED_DIRECTIONS_SIZE(MAX_PATH_LENGTH)];
+} long_path_data;
+
 static array(figure_path_data) paths;
+static array(long_path_data) long_paths;
+
+static uint8_t directions_buffer[MAX_PATH_LENGTH];
+
+typedef struct {
+    int src_offset;
+    int dst_offset;
+    int terrain_usage;
+    int direction_limit;
+    int last_used;
+    int path_length;
+    uint8_t directions[MAX_PATH_LENGTH];
+} route_cache_entry;
+
+static struct {
+    route_cache_entry entries[ROUTE_CACHE_SIZE];
+    int size;
+    int terrain_version;
+    int use_counter;
+    int hits;
+    int misses;
+} cache;
+
+typedef struct {
+    int src_x;
+    int src_y;
+    int dst_x;
+    int dst_y;
+    int terrain_usage;
+    int direction_limit;
+    int can_travel;
+    int path_length;
+    uint8_t directions[MAX_PATH_LENGTH];
+} expected_route;
+
+static struct {
+    expected_route routes[MAX_EXPECTED_ROUTES];
+    int num_routes;
+    int num_tasks;
+    routing_search **searches;
+    int num_searches;
+    int allocation_failed;
+} expected;
+
+static void route_cache_clear(void)
+{
+    cache.size = 0;
+    cache.use_counter = 0;
+    cache.terrain_version = map_routing_terrain_version();
+}
+
+static int route_is_cacheable(const figure *f)
+{
+    // only road routes: they do not depend on fighting figures and draw no random numbers
+    return !f->is_boat &&
+        (f->terrain_usage == TERRAIN_USAGE_ROADS || f->terrain_usage == TERRAIN_USAGE_PREFER_ROADS);
+}
+
+static route_cache_entry *route_cache_find(int src_offset, int dst_offset, int terrain_usage, int direction_limit)
+{
+    if (cache.terrain_version != map_routing_terrain_version()) {
+        route_cache_clear();
+    }
+    for (int i = 0; i < cache.size; i++) {
+        route_cache_entry *entry = &cache.entries[i];
+        if (entry->src_offset == src_offset && entry->dst_offset == dst_offset &&
+            entry->terrain_usage == terrain_usage && entry->direction_limit == direction_limit) {
+            return entry;
+        }
+    }
+    return 0;
+}
+
+static const route_cache_entry *route_cache_get(const figure *f, int direction_limit)
+{
+    route_cache_entry *entry = route_cache_find(map_grid_offset(f->x, f->y),
+        map_grid_offset(f->destination_x, f->destination_y), f->terrain_usage, direction_limit);
+    if (entry) {
+        entry->last_used = ++cache.use_counter;
+        cache.hits++;
+    } else {
+        cache.misses++;
+    }
+    return entry;
+}
+
+static void route_cache_add(int src_offset, int dst_offset, int terrain_usage, int direction_limit,
+    const uint8_t *directions, int path_length)
+{
+    route_cache_entry *entry;
+    if (cache.size < ROUTE_CACHE_SIZE) {
+        entry = &cache.entries[cache.size++];
+    } else {
+        entry = &cache.entries[0];
+        for (int i = 1; i < ROUTE_CACHE_SIZE; i++) {
+            if (cache.entries[i].last_used < entry->last_used) {
+                entry = &cache.entries[i];
+            }
+        }
+    }
+    entry->src_offset = src_offset;
+    entry->dst_offset = dst_offset;
+    entry->terrain_usage = terrain_usage;
+    entry->direction_limit = direction_limit;
+    entry->last_used = ++cache.use_counter;
+    entry->path_length = path_length;
+    memcpy(entry->directions, directions, path_length);
+}
+
+int figure_route_cache_hits(void)
+{
+    return cache.hits;
+}
+
+int figure_route_cache_misses(void)
+{
+    return cache.misses;
+}
 
 static void create_new_path(figure_path_data *path, int position)
 {
@@ -26,10 +165,99 @@ static int path_is_used(const figure_path_data *path)
     return path->figure_id != 0;
 }
 
+static void create_new_long_path(long_path_data *long_path, int position)
+{
+    long_path->id = position;
+}
+
+static int long_path_is_used(const long_path_data *long_path)
+{
+    return long_path->in_use;
+}
+
+static int init_long_paths(void)
+{
+    if (!array_init(long_paths, LONG_PATHS_ARRAY_SIZE_STEP, create_new_long_path, long_path_is_used) ||
+        !array_next(long_paths)) { // Ignore first long path
+        log_error("Unable to create long paths array. The game will likely crash.", 0, 0);
+        return 0;
+    }
+    array_enable_free_slot_tracking(long_paths);
+    return 1;
+}
+
+static void pack_directions(uint8_t *packed, const uint8_t *unpacked, int length)
+{
+    memset(packed, 0, PACKED_DIRECTIONS_SIZE(length));
+    for (int i = 0; i < length; i++) {
+        int bit = i * 3;
+        int value = (unpacked[i] & 7) << (bit & 7);
+        packed[bit >> 3] |= value & 0xff;
+        packed[(bit >> 3) + 1] |= value >> 8;
+    }
+}
+
+static int unpack_direction(const uint8_t *packed, int index)
+{
+    int bit = index * 3;
+    int value = packed[bit >> 3] | (packed[(bit >> 3) + 1] << 8);
+    return (value >> (bit & 7)) & 7;
+}
+
+static uint8_t *path_directions(figure_path_data *path)
+{
+    if (path->long_path_id) {
+        return array_item(long_paths, path->long_path_id)->directions;
+    }
+    return path->directions;
+}
+
+static int reserve_directions(figure_path_data *path, int length)
+{
+    if (length > SHORT_PATH_LENGTH) {
+        long_path_data *long_path;
+        array_new_item(long_paths, 1, long_path);
+        if (!long_path) {
+            return 0;
+        }
+        long_path->in_use = 1;
+        path->long_path_id = long_path->id;
+    }
+    path->length = length;
+    return 1;
+}
+
+static int store_directions(figure_path_data *path, const uint8_t *unpacked, int length)
+{
+    if (!reserve_directions(path, length)) {
+        return 0;
+    }
+    pack_directions(path_directions(path), unpacked, length);
+    return 1;
+}
+
+static void release_path(figure_path_data *path)
+{
+    if (path->long_path_id) {
+        array_item(long_paths, path->long_path_id)->in_use = 0;
+        array_release_item(long_paths, path->long_path_id);
+        path->long_path_id = 0;
+        array_trim(long_paths);
+    }
+    path->figure_id = 0;
+    path->length = 0;
+    array_release_item(paths, path->id);
+}
+
 void figure_route_clear_all(void)
 {
     paths.size = 0;
     array_trim(paths);
+    if (long_paths.blocks) {
+        long_paths.size = 1;
+        array_trim(long_paths);
+    }
+    route_cache_clear();
 }
 
 void figure_route_clean(void)
@@ -41,7 +269,7 @@ void figure_route_clean(void)
         if (figure_id > 0 && figure_id < figure_count()) {
             const figure *f = figure_get(figure_id);
             if (f->state != FIGURE_STATE_ALIVE || f->routing_path_id != i) {
-                path->figure_id = 0;
+                release_path(path);
             }
         }
     }
@@ -57,8 +285,14 @@ void figure_route_add(figure *f)
     if (f->disallow_diagonal) {
         direction_limit = 4;
     }
-    if (!paths.blocks && !array_init(paths, ARRAY_SIZE_STEP, create_new_path, path_is_used)) {
-        log_error("Unable to create paths array. The game will likely crash.", 0, 0);
+    if (!paths.blocks) {
+        if (!array_init(paths, ARRAY_SIZE_STEP, create_new_path, path_is_used)) {
+            log_error("Unable to create paths array. The game will likely crash.", 0, 0);
+            return;
+        }
+        array_enable_free_slot_tracking(paths);
+    }
+    if (!long_paths.blocks && !init_long_paths()) {
         return;
     }
     figure_path_data *path;
@@ -67,14 +301,20 @@ void figure_route_add(figure *f)
         return;
     }
     int path_length;
-    if (f->is_boat) {
+    int is_cacheable = route_is_cacheable(f);
+    const route_cache_entry *cached = is_cacheable ? route_cache_get(f, direction_limit) : 0;
+    if (cached) {
+        map_routing_count_cached_route();
+        path_length = cached->path_length;
+        memcpy(directions_buffer, cached->directions, path_length);
+    } else if (f->is_boat) {
         if (f->is_boat == 2) { // flotsam
             map_routing_calculate_distances_water_flotsam(f->x, f->y);
-            path_length = map_routing_get_path_on_water(path->directions,
+            path_length = map_routing_get_path_on_water(directions_buffer,
                 f->destination_x, f->destination_y, 1);
         } else {
             map_routing_calculate_distances_water_boat(f->x, f->y);
-            path_length = map_routing_get_path_on_water(path->directions,
+            path_length = map_routing_get_path_on_water(directions_buffer,
                 f->destination_x, f->destination_y, 0);
         }
     } else {
@@ -104,6 +344,7 @@ void figure_route_add(figure *f)
             case TERRAIN_USAGE_PREFER_ROADS:
                 can_travel = map_routing_citizen_can_travel_over_road_garden(f->x, f->y,
                     f->destination_x, f->destination_y);
+                is_cacheable = can_travel;
                 if (!can_travel) {
                     can_travel = map_routing_citizen_can_travel_over_land(f->x, f->y,
                         f->destination_x, f->destination_y);
@@ -112,6 +353,7 @@ void figure_route_add(figure *f)
             case TERRAIN_USAGE_ROADS:
                 can_travel = map_routing_citizen_can_travel_over_road_garden(f->x, f->y,
                     f->destination_x, f->destination_y);
+                is_cacheable = can_travel;
                 break;
             default:
                 can_travel = map_routing_citizen_can_travel_over_land(f->x, f->y,
@@ -120,32 +362,132 @@ void figure_route_add(figure *f)
         }
         if (can_travel) {
             if (f->terrain_usage == TERRAIN_USAGE_WALLS) {
-                path_length = map_routing_get_path(path->directions, f->x, f->y,
+                path_length = map_routing_get_path(directions_buffer, f->x, f->y,
                     f->destination_x, f->destination_y, 4);
                 if (path_length <= 0) {
-                    path_length = map_routing_get_path(path->directions, f->x, f->y,
+                    path_length = map_routing_get_path(directions_buffer, f->x, f->y,
                         f->destination_x, f->destination_y, direction_limit);
                 }
             } else {
-                path_length = map_routing_get_path(path->directions, f->x, f->y,
+                path_length = map_routing_get_path(directions_buffer, f->x, f->y,
                     f->destination_x, f->destination_y, direction_limit);
             }
         } else { // cannot travel
             path_length = 0;
         }
+        if (is_cacheable) {
+            route_cache_add(map_grid_offset(f->x, f->y), map_grid_offset(f->destination_x, f->destination_y),
+                f->terrain_usage, direction_limit, directions_buffer, path_length);
+        }
     }
-    if (path_length) {
+    if (path_length && store_directions(path, directions_buffer, path_length)) {
         path->figure_id = f->id;
         f->routing_path_id = path->id;
         f->routing_path_length = path_length;
     }
 }
 
+static int direction_limit_for(const figure *f)
+{
+    return f->disallow_diagonal ? 4 : 8;
+}
+
+static int is_expected_to_route(const figure *f)
+{
+    // a walker without a route that waits at the end of a tile asks for one when it moves on
+    if (f->state != FIGURE_STATE_ALIVE || f->routing_path_id > 0 || f->progress_on_tile < 15 ||
+        f->use_cross_country || !route_is_cacheable(f)) {
+        return 0;
+    }
+    if ((f->x == f->destination_x && f->y == f->destination_y) ||
+        !map_grid_is_inside(f->destination_x, f->destination_y, 1)) {
+        return 0;
+    }
+    return !route_cache_find(map_grid_offset(f->x, f->y), map_grid_offset(f->destination_x, f->destination_y),
+        f->terrain_usage, direction_limit_for(f));
+}
+
+static int reserve_searches(int num_searches)
+{
+    if (num_searches <= expected.num_searches) {
+        return 1;
+    }
+    routing_search **searches = realloc(expected.searches, num_searches * sizeof(routing_search *));
+    if (!searches) {
+        return 0;
+    }
+    expected.searches = searches;
+    while (expected.num_searches < num_searches) {
+        routing_search *search = map_routing_search_create();
+        if (!search) {
+            return 0;
+        }
+        expected.searches[expected.num_searches++] = search;
+    }
+    return 1;
+}
+
+static void find_expected_routes(int index, void *userdata)
+{
+    routing_search *search = expected.searches[index];
+    for (int i = index; i < expected.num_routes; i += expected.num_tasks) {
+        expected_route *route = &expected.routes[i];
+        route->can_travel = map_routing_search_citizen_road_garden(search,
+            route->src_x, route->src_y, route->dst_x, route->dst_y);
+        route->path_length = route->can_travel ? map_routing_search_get_path(search, route->directions,
+            route->src_x, route->src_y, route->dst_x, route->dst_y, route->direction_limit) : 0;
+    }
+}
+
+void figure_route_find_expected(void)
+{
+    int num_threads = thread_pool_num_threads();
+    if (num_threads <= 1 || expected.allocation_failed) {
+        return;
+    }
+    expected.num_routes = 0;
+    for (int i = 1; i < figure_count() && expected.num_routes < MAX_EXPECTED_ROUTES; i++) {
+        figure *f = figure_get(i);
+        if (is_expected_to_route(f)) {
+            expected_route *route = &expected.routes[expected.num_routes++];
+            route->src_x = f->x;
+            route->src_y = f->y;
+            route->dst_x = f->destination_x;
+            route->dst_y = f->destination_y;
+            route->terrain_usage = f->terrain_usage;
+            route->direction_limit = direction_limit_for(f);
+        }
+    }
+    expected.num_tasks = expected.num_routes < num_threads ? expected.num_routes : num_threads;
+    if (!expected.num_tasks) {
+        return;
+    }
+    if (!reserve_searches(expected.num_tasks)) {
+        log_error("Unable to allocate memory for route searches on the worker threads", 0, 0);
+        expected.allocation_failed = 1;
+        return;
+    }
+    map_routing_search_prepare();
+    thread_pool_run(find_expected_routes, expected.num_tasks, 0);
+
+    // Only routes that were found are cached, the same as in figure_route_add
+    for (int i = 0; i < expected.num_routes; i++) {
+        const expected_route *route = &expected.routes[i];
+        int src_offset = map_grid_offset(route->src_x, route->src_y);
+        int dst_offset = map_grid_offset(route->dst_x, route->dst_y);
+        if (route->can_travel &&
+            !route_cache_find(src_offset, dst_offset, route->terrain_usage, route->direction_limit)) {
+            route_cache_add(src_offset, dst_offset, route->terrain_usage, route->direction_limit,
+                route->directions, route->path_length);
+        }
+    }
+}
+
 void figure_route_remove(figure *f)
 {
     if (f->routing_path_id > 0) {
         if (f->routing_path_id < paths.size && array_item(paths, f->routing_path_id)->figure_id == f->id) {
-            array_item(paths, f->routing_path_id)->figure_id = 0;
+            release_path(array_item(paths, f->routing_path_id));
         }
         f->routing_path_id = 0;
     }
@@ -154,43 +496,98 @@ void figure_route_remove(figure *f)
 
 int figure_route_get_direction(int path_id, int index)
 {
-    return array_item(paths, path_id)->directions[index];
+    figure_path_data *path = array_item(paths, path_id);
+    if (index >= path->length) {
+        return 0;
+    }
+    return unpack_direction(path_directions(path), index);
+}
+
+// Paths that no longer belong to their figure are never read again
+static int owned_path_length(const figure_path_data *path, int max_length)
+{
+    if (path->figure_id <= 0 || path->figure_id >= figure_count()) {
+        return 0;
+    }
+    const figure *f = figure_get(path->figure_id);
+    if (f->routing_path_id != path->id) {
+        return 0;
+    }
+    return f->routing_path_length < max_length ? f->routing_path_length : max_length;
 }
 
 void figure_route_save_state(buffer *figures, buffer *buf_paths)
 {
-    int size = paths.size * sizeof(int);
+    int size = paths.size * 2 * sizeof(int16_t);
     uint8_t *buf_data = malloc(size);
     buffer_init(figures, buf_data, size);
 
-    size = paths.size * sizeof(uint8_t) * MAX_PATH_LENGTH;
+    size = 0;
+    figure_path_data *path;
+    array_foreach(paths, path)
+    {
+        size += PACKED_DIRECTIONS_SIZE(owned_path_length(path, path->length)) - 1;
+    }
     buf_data = malloc(size);
     buffer_init(buf_paths, buf_data, size);
 
-    figure_path_data *path;
     array_foreach(paths, path)
     {
+        int length = owned_path_length(path, path->length);
         buffer_write_i16(figures, path->figure_id);
-        buffer_write_raw(buf_paths, path->directions, MAX_PATH_LENGTH);
+        buffer_write_i16(figures, length);
+        if (length) {
+            buffer_write_raw(buf_paths, path_directions(path), PACKED_DIRECTIONS_SIZE(length) - 1);
+        }
+    }
+}
+
+static void load_packed_path(figure_path_data *path, buffer *figures, buffer *buf_paths)
+{
+    int length = buffer_read_i16(figures);
+    if (length <= 0 || length > MAX_PATH_LENGTH) {
+        return;
+    }
+    int size = PACKED_DIRECTIONS_SIZE(length) - 1;
+    if (reserve_directions(path, length)) {
+        buffer_read_raw(buf_paths, path_directions(path), size);
+    } else {
+        buffer_skip(buf_paths, size);
     }
 }
 
-void figure_route_load_state(buffer *figures, buffer *buf_paths)
+static void load_unpacked_path(figure_path_data *path, buffer *buf_paths)
 {
-    int elements_to_load = buf_paths->size / MAX_PATH_LENGTH;
+    buffer_read_raw(buf_paths, directions_buffer, MAX_PATH_LENGTH);
+    // The full path is stored, but only its owning figure knows how long it actually is
+    int length = owned_path_length(path, MAX_PATH_LENGTH);
+    if (length > 0) {
+        store_directions(path, directions_buffer, length);
+    }
+}
+
+void figure_route_load_state(buffer *figures, buffer *buf_paths, int has_packed_paths)
+{
+    int elements_to_load = has_packed_paths ?
+        figures->size / (2 * sizeof(int16_t)) : buf_paths->size / MAX_PATH_LENGTH;
 
     if (!array_init(paths, ARRAY_SIZE_STEP, create_new_path, path_is_used) ||
-        !array_expand(paths, elements_to_load)) {
+        !array_expand(paths, elements_to_load) || !init_long_paths()) {
         log_error("Unable to create paths array. The game will likely crash.", 0, 0);
         return;
     }
+    array_enable_free_slot_tracking(paths);
 
     int highest_id_in_use = 0;
 
     for (int i = 0; i < elements_to_load; i++) {
         figure_path_data *path = array_next(paths);
         path->figure_id = buffer_read_i16(figures);
-        buffer_read_raw(buf_paths, path->directions, MAX_PATH_LENGTH);
+        if (has_packed_paths) {
+            load_packed_path(path, figures, buf_paths);
+        } else {
+            load_unpacked_path(path, buf_paths);
+        }
         if (path->figure_id) {
             highest_id_in_use = i;
         }
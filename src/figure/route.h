@@ -10,12 +10,30 @@ void figure_route_clean(void);
 
 void figure_route_add(figure *f);
 
+/**
+ * Searches, on the worker threads, the road routes that walkers are expected to ask for this tick,
+ * and caches them in figure id order. Searching changes no game state, and cached routes are the same
+ * as searched ones, so the figures that follow behave the same. Does nothing without worker threads.
+ */
+void figure_route_find_expected(void);
+
 void figure_route_remove(figure *f);
 
 int figure_route_get_direction(int path_id, int index);
 
+/**
+ * Road routes are cached until the routing terrain changes
+ * @return Number of routes served from the cache
+ */
+int figure_route_cache_hits(void);
+
+/**
+ * @return Number of cacheable routes that had to be searched for
+ */
+int figure_route_cache_misses(void);
+
 void figure_route_save_state(buffer *figures, buffer *buf_paths);
 
-void figure_route_load_state(buffer *figures, buffer *buf_paths);
+void figure_route_load_state(buffer *figures, buffer *buf_paths, int has_packed_paths);
 
 #endif // FIGURE_ROUTE_H
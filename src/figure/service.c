@@ -14,23 +14,25 @@
 
 #define MAX_COVERAGE 96
 #define TOURISM_COOLDOWN 96
+#define MAX_HOUSES_IN_RANGE 25
 
-static int provide_culture(int x, int y, void (*callback)(building *))
+static int houses_in_range(int x, int y, int *house_ids)
 {
-    int serviced = 0;
     int x_min, y_min, x_max, y_max;
     map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    callback(b);
-                    serviced++;
-                }
-            }
+    return map_building_houses_in_area(x_min, y_min, x_max, y_max, house_ids, MAX_HOUSES_IN_RANGE);
+}
+
+static int provide_culture(int x, int y, void (*callback)(building *))
+{
+    int serviced = 0;
+    int house_ids[MAX_HOUSES_IN_RANGE];
+    int num_houses = houses_in_range(x, y, house_ids);
+    for (int i = 0; i < num_houses; i++) {
+        building *b = building_get(house_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            callback(b);
+            serviced++;
         }
     }
     return serviced;
@@ -39,19 +41,13 @@ static int provide_culture(int x, int y, void (*callback)(building *))
 static int provide_entertainment(int x, int y, int shows, void (*callback)(building *, int))
 {
     int serviced = 0;
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    callback(b, shows);
-                    serviced++;
-                }
-            }
+    int house_ids[MAX_HOUSES_IN_RANGE];
+    int num_houses = houses_in_range(x, y, house_ids);
+    for (int i = 0; i < num_houses; i++) {
+        building *b = building_get(house_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            callback(b, shows);
+            serviced++;
         }
     }
     return serviced;
@@ -391,20 +387,13 @@ static int provide_market_goods(int market_building_id, int x, int y)
 {
     int serviced = 0;
     building *market = building_get(market_building_id);
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    distribute_market_resources(b, market);
-                    serviced++;
-                }
-
-            }
+    int house_ids[MAX_HOUSES_IN_RANGE];
+    int num_houses = houses_in_range(x, y, house_ids);
+    for (int i = 0; i < num_houses; i++) {
+        building *b = building_get(house_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            distribute_market_resources(b, market);
+            serviced++;
         }
     }
     return serviced;
@@ -445,19 +434,13 @@ static int collect_offerings(int market_building_id, int x, int y)
 {
     int serviced = 0;
     building *market = building_get(market_building_id);
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    collect_offerings_from_house(b, market);
-                    serviced++;
-                }
-            }
+    int house_ids[MAX_HOUSES_IN_RANGE];
+    int num_houses = houses_in_range(x, y, house_ids);
+    for (int i = 0; i < num_houses; i++) {
+        building *b = building_get(house_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            collect_offerings_from_house(b, market);
+            serviced++;
         }
     }
     return serviced;
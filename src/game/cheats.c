@@ -13,6 +13,7 @@
 #include "core/string.h"
 #include "empire/city.h"
 #include "figure/figure.h"
+#include "figure/route.h"
 #include "figuretype/crime.h"
 #include "game/tick.h"
 #include "graphics/color.h"
@@ -26,7 +27,7 @@
 #include "window/console.h"
 #include <string.h>
 
-#define NUMBER_OF_COMMANDS 10
+#define NUMBER_OF_COMMANDS 11
 
 static void game_cheat_add_money(uint8_t *);
 static void game_cheat_start_invasion(uint8_t *);
@@ -38,6 +39,7 @@ static void game_cheat_finish_monuments(uint8_t *);
 static void game_cheat_set_monument_phase(uint8_t *);
 static void game_cheat_unlock_all_buildings(uint8_t *);
 static void game_cheat_incite_riot(uint8_t *);
+static void game_cheat_show_route_cache(uint8_t *);
 
 static void (*const execute_command[])(uint8_t *args) = {
     game_cheat_add_money,
@@ -49,7 +51,8 @@ static void (*const execute_command[])(uint8_t *args) = {
     game_cheat_finish_monuments,
     game_cheat_set_monument_phase,
     game_cheat_unlock_all_buildings,
-    game_cheat_incite_riot
+    game_cheat_incite_riot,
+    game_cheat_show_route_cache
 };
 
 static const char *commands[] = {
@@ -62,7 +65,8 @@ static const char *commands[] = {
     "finishmonuments",
     "monumentphase",
     "whathaveromansdoneforus",
-    "nike"
+    "nike",
+    "routecache"
 };
 
 static struct {
@@ -231,6 +235,16 @@ static void game_cheat_incite_riot(uint8_t *args)
 }
 
 
+static void game_cheat_show_route_cache(uint8_t *args)
+{
+    uint8_t text[MAX_COMMAND_SIZE];
+    uint8_t *cursor = string_copy(string_from_ascii("Route cache hits: "), text, MAX_COMMAND_SIZE);
+    cursor += string_from_int(cursor, figure_route_cache_hits(), 0);
+    cursor = string_copy(string_from_ascii(" misses: "), cursor, MAX_COMMAND_SIZE - (int) (cursor - text));
+    string_from_int(cursor, figure_route_cache_misses(), 0);
+    city_warning_show_console(text);
+}
+
 void game_cheat_parse_command(uint8_t *command)
 {
     uint8_t command_to_call[MAX_COMMAND_SIZE];
@@ -395,6 +395,16 @@ int game_file_write_saved_game(const char *filename)
     return game_file_io_write_saved_game(filename);
 }
 
+int game_file_write_saved_game_in_background(const char *filename, void (*callback)(int success))
+{
+    return game_file_io_write_saved_game_in_background(filename, callback);
+}
+
+void game_file_finish_background_save(int wait)
+{
+    game_file_io_finish_background_save(wait);
+}
+
 int game_file_delete_saved_game(const char *filename)
 {
     return game_file_io_delete_saved_game(filename);
@@ -38,6 +38,23 @@ int game_file_load_saved_game(const char *filename);
  */
 int game_file_write_saved_game(const char *filename);
 
+/**
+ * Write saved game to disk on a background thread.
+ * The game state is saved right away, only compressing and writing it happens in the background.
+ * Where the platform can rename files, it is written to a temporary file that replaces the saved game when done.
+ * Loading, saving or deleting a game waits for the background save to finish.
+ * @param filename File to save to
+ * @param callback Function called on the game thread when the save has finished, or 0
+ * @return Boolean true if the save was started, false on failure
+ */
+int game_file_write_saved_game_in_background(const char *filename, void (*callback)(int success));
+
+/**
+ * Finish the background save when it has written its file, and report its result to its callback
+ * @param wait Whether to wait for a background save that is still writing
+ */
+void game_file_finish_background_save(int wait);
+
 /**
  * Delete saved game
  * @param filename File to delete
@@ -14,6 +14,7 @@
 #include "city/view.h"
 #include "core/dir.h"
 #include "core/random.h"
+#include "core/thread_pool.h"
 #include "core/zip.h"
 #include "empire/city.h"
 #include "empire/empire.h"
@@ -57,7 +58,7 @@
 
 #define PIECE_SIZE_DYNAMIC 0
 
-static const int SAVE_GAME_CURRENT_VERSION = 0x86;
+static const int SAVE_GAME_CURRENT_VERSION = 0x88;
 
 static const int SAVE_GAME_LAST_ORIGINAL_LIMITS_VERSION = 0x66;
 static const int SAVE_GAME_LAST_SMALLER_IMAGE_ID_VERSION = 0x76;
@@ -70,16 +71,23 @@ static const int SAVE_GAME_LAST_STORED_IMAGE_IDS = 0x83;
 // SAVE_GAME_INCREASE_GRANARY_CAPACITY shall be updated if we decide to change granary capacity again.
 static const int SAVE_GAME_INCREASE_GRANARY_CAPACITY = 0x85;
 // static const int SAVE_GAME_ROADBLOCK_DATA_MOVED_FROM_SUBTYPE = 0x86; This define is unneeded for now
+static const int SAVE_GAME_LAST_UNPACKED_ROUTES_VERSION = 0x86;
+static const int SAVE_GAME_LAST_IMPLODE_ONLY_VERSION = 0x87;
 
 
-static char compress_buffer[COMPRESS_BUFFER_SIZE];
-
 typedef struct {
     buffer buf;
     int compressed;
     int dynamic;
 } file_piece;
 
+typedef struct {
+    uint8_t *data;
+    int size;
+    savegame_compression compression;
+    int result;
+} file_chunk;
+
 typedef struct {
     buffer *graphic_ids;
     buffer *edge;
@@ -192,6 +200,20 @@ static struct {
     savegame_state state;
 } savegame_data;
 
+static savegame_compression save_compression = SAVEGAME_COMPRESSION_DEFLATE;
+
+static struct {
+    int in_progress;
+    int num_pieces;
+    file_piece pieces[100];
+    savegame_compression compression;
+    FILE *fp;
+    int result;
+    char filename[FILE_NAME_MAX];
+    char temp_filename[FILE_NAME_MAX];
+    void (*callback)(int success);
+} background_save;
+
 static void init_file_piece(file_piece *piece, int size, int compressed)
 {
     piece->compressed = compressed;
@@ -430,7 +452,8 @@ static void savegame_load_from_state(savegame_state *state, int version)
     map_desirability_load_state(state->desirability_grid);
     map_elevation_load_state(state->elevation_grid);
     figure_load_state(state->figures, state->figure_sequence, version > SAVE_GAME_LAST_STATIC_VERSION);
-    figure_route_load_state(state->route_figures, state->route_paths);
+    figure_route_load_state(state->route_figures, state->route_paths,
+        version > SAVE_GAME_LAST_UNPACKED_ROUTES_VERSION);
     formations_load_state(state->formations, state->formation_totals, version > SAVE_GAME_LAST_STATIC_VERSION);
 
     city_data_load_state(state->city_data,
@@ -648,44 +671,99 @@ static void write_int32(FILE *fp, int value)
     fwrite(&data, 1, 4, fp);
 }
 
-static int read_compressed_chunk(FILE *fp, void *buffer, int bytes_to_read)
+typedef struct {
+    file_piece *pieces;
+    file_chunk *chunks;
+    savegame_compression compression;
+} piece_chunks;
+
+static void compress_chunk(int index, void *userdata)
 {
-    if (bytes_to_read > COMPRESS_BUFFER_SIZE) {
-        return 0;
+    piece_chunks *job = userdata;
+    const file_piece *piece = &job->pieces[index];
+    file_chunk *chunk = &job->chunks[index];
+    chunk->data = 0;
+    chunk->size = 0;
+    chunk->compression = job->compression;
+    if (!piece->compressed || !piece->buf.size || piece->buf.size > COMPRESS_BUFFER_SIZE) {
+        return;
     }
-    int input_size = read_int32(fp);
-    if ((unsigned int) input_size == UNCOMPRESSED) {
-        if (fread(buffer, 1, bytes_to_read, fp) != bytes_to_read) {
-            return 0;
+    // Imploding stores a literal byte in 9 bits, so the output can be slightly larger than the input
+    int output_size = piece->buf.size + piece->buf.size / 8 + 64;
+    if (output_size > COMPRESS_BUFFER_SIZE) {
+        output_size = COMPRESS_BUFFER_SIZE;
+    }
+    chunk->data = malloc(output_size);
+    int compressed = 0;
+    if (chunk->data) {
+        if (chunk->compression == SAVEGAME_COMPRESSION_DEFLATE) {
+            compressed = zip_deflate(piece->buf.data, piece->buf.size, chunk->data, &output_size);
+        } else {
+            compressed = zip_compress(piece->buf.data, piece->buf.size, chunk->data, &output_size);
         }
+    }
+    if (compressed) {
+        chunk->size = output_size;
     } else {
-        if (fread(compress_buffer, 1, input_size, fp) != input_size
-            || !zip_decompress(compress_buffer, input_size, buffer, &bytes_to_read)) {
-            return 0;
+        // unable to compress: written uncompressed
+        free(chunk->data);
+        chunk->data = 0;
+    }
+}
+
+static void decompress_chunk(int index, void *userdata)
+{
+    piece_chunks *job = userdata;
+    file_piece *piece = &job->pieces[index];
+    file_chunk *chunk = &job->chunks[index];
+    if (chunk->data) {
+        int bytes_to_read = piece->buf.size;
+        if (chunk->compression == SAVEGAME_COMPRESSION_DEFLATE) {
+            chunk->result = zip_inflate(chunk->data, chunk->size, piece->buf.data, &bytes_to_read);
+        } else {
+            chunk->result = zip_decompress(chunk->data, chunk->size, piece->buf.data, &bytes_to_read);
         }
+        free(chunk->data);
+        chunk->data = 0;
     }
-    return 1;
 }
 
-static int write_compressed_chunk(FILE *fp, const void *buffer, int bytes_to_write)
+static int read_compressed_chunk(FILE *fp, file_piece *piece, file_chunk *chunk, int version)
 {
-    if (bytes_to_write > COMPRESS_BUFFER_SIZE) {
+    if (piece->buf.size > COMPRESS_BUFFER_SIZE) {
         return 0;
     }
-    int output_size = COMPRESS_BUFFER_SIZE;
-    if (zip_compress(buffer, bytes_to_write, compress_buffer, &output_size)) {
-        write_int32(fp, output_size);
-        fwrite(compress_buffer, 1, output_size, fp);
-    } else {
-        // unable to compress: write uncompressed
-        write_int32(fp, UNCOMPRESSED);
-        fwrite(buffer, 1, bytes_to_write, fp);
+    chunk->compression = SAVEGAME_COMPRESSION_IMPLODE;
+    if (version > SAVE_GAME_LAST_IMPLODE_ONLY_VERSION) {
+        chunk->compression = read_int32(fp);
+        if (chunk->compression != SAVEGAME_COMPRESSION_IMPLODE && chunk->compression != SAVEGAME_COMPRESSION_DEFLATE) {
+            log_error("Unknown compression for piece", 0, chunk->compression);
+            return 0;
+        }
+    }
+    int input_size = read_int32(fp);
+    if ((unsigned int) input_size == UNCOMPRESSED) {
+        return fread(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
     }
+    if (input_size <= 0 || input_size > COMPRESS_BUFFER_SIZE) {
+        return 0;
+    }
+    chunk->data = malloc(input_size);
+    if (!chunk->data || fread(chunk->data, 1, input_size, fp) != input_size) {
+        free(chunk->data);
+        chunk->data = 0;
+        return 0;
+    }
+    // Decompressed later, together with the other pieces
+    chunk->size = input_size;
     return 1;
 }
 
-static int savegame_read_from_file(FILE *fp)
+static int savegame_read_from_file(FILE *fp, int version)
 {
+    file_chunk chunks[sizeof(savegame_data.pieces) / sizeof(file_piece)];
+    memset(chunks, 0, sizeof(chunks));
+    int num_pieces = savegame_data.num_pieces;
     for (int i = 0; i < savegame_data.num_pieces; i++) {
         file_piece *piece = &savegame_data.pieces[i];
         int result = 0;
@@ -699,7 +777,7 @@ static int savegame_read_from_file(FILE *fp)
             buffer_init(&piece->buf, data, size);
         }
         if (piece->compressed) {
-            result = read_compressed_chunk(fp, piece->buf.data, piece->buf.size);
+            result = read_compressed_chunk(fp, piece, &chunks[i], version);
         } else {
             result = fread(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
         }
@@ -707,30 +785,98 @@ static int savegame_read_from_file(FILE *fp)
         if (!result && i != (savegame_data.num_pieces - 1)) {
             log_info("Incorrect buffer size, got", 0, result);
             log_info("Incorrect buffer size, expected", 0, piece->buf.size);
+            num_pieces = i;
+            break;
+        }
+    }
+    // Each chunk knows its own compression when reading
+    piece_chunks job = { savegame_data.pieces, chunks, SAVEGAME_COMPRESSION_IMPLODE };
+    thread_pool_run(decompress_chunk, num_pieces, &job);
+    if (num_pieces < savegame_data.num_pieces) {
+        return 0;
+    }
+    for (int i = 0; i < savegame_data.num_pieces - 1; i++) {
+        if (chunks[i].size && !chunks[i].result) {
+            log_error("Unable to decompress piece", 0, i);
             return 0;
         }
     }
     return 1;
 }
 
-static void savegame_write_to_file(FILE *fp)
+static void savegame_write_to_file(FILE *fp, file_piece *pieces, int num_pieces,
+    savegame_compression compression, int use_thread_pool)
 {
-    for (int i = 0; i < savegame_data.num_pieces; i++) {
-        file_piece *piece = &savegame_data.pieces[i];
+    file_chunk chunks[sizeof(savegame_data.pieces) / sizeof(file_piece)];
+    piece_chunks job = { pieces, chunks, compression };
+    if (use_thread_pool) {
+        thread_pool_run(compress_chunk, num_pieces, &job);
+    } else {
+        for (int i = 0; i < num_pieces; i++) {
+            compress_chunk(i, &job);
+        }
+    }
+    for (int i = 0; i < num_pieces; i++) {
+        const file_piece *piece = &pieces[i];
         if (piece->dynamic) {
             write_int32(fp, piece->buf.size);
             if (!piece->buf.size) {
                 continue;
             }
         }
-        if (piece->compressed) {
-            write_compressed_chunk(fp, piece->buf.data, piece->buf.size);
-        } else {
+        if (!piece->compressed) {
+            fwrite(piece->buf.data, 1, piece->buf.size, fp);
+        } else if (chunks[i].data) {
+            write_int32(fp, chunks[i].compression);
+            write_int32(fp, chunks[i].size);
+            fwrite(chunks[i].data, 1, chunks[i].size, fp);
+            free(chunks[i].data);
+        } else if (piece->buf.size <= COMPRESS_BUFFER_SIZE) {
+            write_int32(fp, chunks[i].compression);
+            write_int32(fp, UNCOMPRESSED);
             fwrite(piece->buf.data, 1, piece->buf.size, fp);
         }
     }
 }
 
+static void write_saved_game_in_background(void *userdata)
+{
+    // The worker threads may be busy on the game thread at the same time
+    savegame_write_to_file(background_save.fp, background_save.pieces, background_save.num_pieces,
+        background_save.compression, 0);
+    int failed = ferror(background_save.fp);
+    background_save.result = file_close(background_save.fp) == 0 && !failed;
+    for (int i = 0; i < background_save.num_pieces; i++) {
+        free(background_save.pieces[i].buf.data);
+    }
+    background_save.num_pieces = 0;
+}
+
+static void finish_background_save(void)
+{
+    if (!background_save.in_progress) {
+        return;
+    }
+    thread_pool_wait_for_background();
+    background_save.in_progress = 0;
+    int result = background_save.result;
+    int uses_temp_file = strcmp(background_save.temp_filename, background_save.filename) != 0;
+    if (result && uses_temp_file) {
+        result = file_rename(background_save.temp_filename, background_save.filename);
+    }
+    if (result) {
+        log_info("Saved game", background_save.filename, 0);
+    } else {
+        log_error("Unable to save game", background_save.filename, 0);
+        if (uses_temp_file) {
+            file_remove(background_save.temp_filename);
+        }
+    }
+    if (background_save.callback) {
+        background_save.callback(result);
+    }
+}
+
 static int get_savegame_version(FILE *fp)
 {
     buffer buf;
@@ -746,6 +892,7 @@ static int get_savegame_version(FILE *fp)
 
 int game_file_io_read_saved_game(const char *filename, int offset)
 {
+    finish_background_save();
     log_info("Loading saved game", filename, 0);
     FILE *fp = file_open(dir_get_file(filename, NOT_LOCALIZED), "rb");
     if (!fp) {
@@ -764,7 +911,7 @@ int game_file_io_read_saved_game(const char *filename, int offset)
         }
         log_info("Savegame version", 0, version);
         init_savegame_data(version);
-        result = savegame_read_from_file(fp);
+        result = savegame_read_from_file(fp, version);
     }
     file_close(fp);
     if (!result) {
@@ -777,6 +924,7 @@ int game_file_io_read_saved_game(const char *filename, int offset)
 
 int game_file_io_write_saved_game(const char *filename)
 {
+    finish_background_save();
     init_savegame_data(SAVE_GAME_CURRENT_VERSION);
 
     log_info("Saving game", filename, 0);
@@ -787,13 +935,54 @@ int game_file_io_write_saved_game(const char *filename)
         log_error("Unable to save game", 0, 0);
         return 0;
     }
-    savegame_write_to_file(fp);
+    savegame_write_to_file(fp, savegame_data.pieces, savegame_data.num_pieces, save_compression, 1);
     file_close(fp);
     return 1;
 }
 
+int game_file_io_write_saved_game_in_background(const char *filename, void (*callback)(int success))
+{
+    finish_background_save();
+    init_savegame_data(SAVE_GAME_CURRENT_VERSION);
+
+    log_info("Saving game in the background", filename, 0);
+    savegame_save_to_state(&savegame_data.state);
+
+    // Written to a temporary file that replaces the saved game when done,
+    // so quitting or crashing halfway keeps the previous saved game intact
+    strncpy(background_save.filename, filename, FILE_NAME_MAX - 1);
+    if (!file_can_rename() || snprintf(background_save.temp_filename, FILE_NAME_MAX,
+            "%s.tmp", filename) >= FILE_NAME_MAX) {
+        strncpy(background_save.temp_filename, filename, FILE_NAME_MAX - 1);
+    }
+    FILE *fp = file_open(background_save.temp_filename, "wb");
+    if (!fp) {
+        log_error("Unable to save game", 0, 0);
+        return 0;
+    }
+    // The background save takes over the pieces, and frees them when done
+    memcpy(background_save.pieces, savegame_data.pieces, savegame_data.num_pieces * sizeof(file_piece));
+    background_save.num_pieces = savegame_data.num_pieces;
+    savegame_data.num_pieces = 0;
+    background_save.fp = fp;
+    background_save.compression = save_compression;
+    background_save.result = 0;
+    background_save.callback = callback;
+    background_save.in_progress = 1;
+    thread_pool_run_in_background(write_saved_game_in_background, 0);
+    return 1;
+}
+
+void game_file_io_finish_background_save(int wait)
+{
+    if (wait || !thread_pool_background_is_running()) {
+        finish_background_save();
+    }
+}
+
 int game_file_io_delete_saved_game(const char *filename)
 {
+    finish_background_save();
     log_info("Deleting game", filename, 0);
     int result = file_remove(filename);
     if (!result) {
@@ -801,3 +990,8 @@ int game_file_io_delete_saved_game(const char *filename)
     }
     return result;
 }
+
+void game_file_io_set_savegame_compression(savegame_compression compression)
+{
+    save_compression = compression;
+}
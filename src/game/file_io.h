@@ -1,6 +1,12 @@
 #ifndef GAME_FILE_IO_H
 #define GAME_FILE_IO_H
 
+// Stored in the saved game for each compressed piece: do not renumber
+typedef enum {
+    SAVEGAME_COMPRESSION_IMPLODE = 0,
+    SAVEGAME_COMPRESSION_DEFLATE = 1
+} savegame_compression;
+
 int game_file_io_read_scenario(const char *filename);
 
 int game_file_io_write_scenario(const char *filename);
@@ -9,6 +15,12 @@ int game_file_io_read_saved_game(const char *filename, int offset);
 
 int game_file_io_write_saved_game(const char *filename);
 
+int game_file_io_write_saved_game_in_background(const char *filename, void (*callback)(int success));
+
+void game_file_io_finish_background_save(int wait);
+
 int game_file_io_delete_saved_game(const char *filename);
 
+void game_file_io_set_savegame_compression(savegame_compression compression);
+
 #endif // GAME_FILE_IO_H
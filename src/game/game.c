@@ -175,6 +175,7 @@ int game_reload_language(void)
 
 void game_run(void)
 {
+    game_file_finish_background_save(0);
     game_animation_update();
     int num_ticks = game_speed_get_elapsed_ticks();
     for (int i = 0; i < num_ticks; i++) {
@@ -195,6 +196,7 @@ void game_draw(void)
 
 void game_exit(void)
 {
+    game_file_finish_background_save(1);
     video_shutdown();
     settings_save();
     config_save();
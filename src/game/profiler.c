@@ -0,0 +1,184 @@
+#include "profiler.h"
+
+#include "game/tick.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define WINDOW_TICKS (5 * PROFILER_TICKS_PER_DAY)
+
+typedef struct {
+    int histogram[PROFILER_HISTOGRAM_BUCKETS];
+    uint64_t max_time;
+} profiler_window;
+
+static struct {
+    uint64_t (*clock)(void);
+    uint64_t frequency;
+    uint64_t started[PROFILER_SECTION_MAX];
+    uint64_t tick_time[PROFILER_SECTION_MAX];
+    int measured_in_tick[PROFILER_SECTION_MAX];
+    profiler_stats stats[PROFILER_SECTION_MAX];
+    // The rolling histogram is made of the current and the previous window
+    profiler_window windows[2][PROFILER_SECTION_MAX];
+    int current_window;
+    int window_ticks;
+    char figure_type_names[FIGURE_TYPE_MAX][32];
+} data;
+
+static const char *SECTION_NAMES[PROFILER_SECTION_FIGURE_TYPE - PROFILER_SECTION_DAY] = {
+    "advance_day",
+    "advance_month",
+    "advance_year",
+    "figure_action_handle",
+    "scenario_events",
+    "game_tick_run"
+};
+
+void profiler_set_clock(uint64_t (*clock)(void), uint64_t frequency)
+{
+    data.clock = frequency ? clock : 0;
+    data.frequency = frequency;
+    profiler_reset();
+}
+
+int profiler_is_enabled(void)
+{
+    return data.clock != 0;
+}
+
+void profiler_start(int section)
+{
+    if (data.clock) {
+        data.started[section] = data.clock();
+    }
+}
+
+void profiler_stop(int section)
+{
+    if (!data.clock) {
+        return;
+    }
+    uint64_t elapsed = data.clock() - data.started[section];
+    profiler_stats *stats = &data.stats[section];
+    stats->calls++;
+    stats->total_time += elapsed;
+    if (elapsed > stats->max_time) {
+        stats->max_time = elapsed;
+    }
+    data.tick_time[section] += elapsed;
+    data.measured_in_tick[section] = 1;
+}
+
+static int histogram_bucket(uint64_t time)
+{
+    uint64_t micros = time * 1000000 / data.frequency;
+    int bucket = 0;
+    while (micros && bucket < PROFILER_HISTOGRAM_BUCKETS - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void profiler_end_tick(void)
+{
+    if (!data.clock) {
+        return;
+    }
+    profiler_window *windows = data.windows[data.current_window];
+    for (int i = 0; i < PROFILER_SECTION_MAX; i++) {
+        if (!data.measured_in_tick[i]) {
+            continue;
+        }
+        uint64_t time = data.tick_time[i];
+        windows[i].histogram[histogram_bucket(time)]++;
+        if (time > windows[i].max_time) {
+            windows[i].max_time = time;
+        }
+        data.tick_time[i] = 0;
+        data.measured_in_tick[i] = 0;
+    }
+    if (++data.window_ticks >= WINDOW_TICKS) {
+        data.window_ticks = 0;
+        data.current_window ^= 1;
+        memset(data.windows[data.current_window], 0, sizeof(data.windows[0]));
+    }
+}
+
+void profiler_reset(void)
+{
+    memset(data.stats, 0, sizeof(data.stats));
+    memset(data.windows, 0, sizeof(data.windows));
+    memset(data.tick_time, 0, sizeof(data.tick_time));
+    memset(data.measured_in_tick, 0, sizeof(data.measured_in_tick));
+    data.window_ticks = 0;
+}
+
+const profiler_stats *profiler_get_stats(int section)
+{
+    return &data.stats[section];
+}
+
+int profiler_get_histogram(int section, int bucket)
+{
+    return data.windows[0][section].histogram[bucket] + data.windows[1][section].histogram[bucket];
+}
+
+uint64_t profiler_get_recent_max(int section)
+{
+    uint64_t current = data.windows[0][section].max_time;
+    uint64_t previous = data.windows[1][section].max_time;
+    return current > previous ? current : previous;
+}
+
+static int is_group_section(int section)
+{
+    return section == PROFILER_SECTION_DAY || section == PROFILER_SECTION_FIGURE_ACTIONS ||
+        section == PROFILER_SECTION_GAME_TICK;
+}
+
+int profiler_get_worst_sections(int *sections, int max_sections)
+{
+    int num_sections = 0;
+    for (int i = 0; i < PROFILER_SECTION_MAX; i++) {
+        uint64_t time = profiler_get_recent_max(i);
+        if (!time || is_group_section(i)) {
+            continue;
+        }
+        int position = num_sections < max_sections ? num_sections++ : max_sections;
+        while (position > 0 && profiler_get_recent_max(sections[position - 1]) < time) {
+            if (position < max_sections) {
+                sections[position] = sections[position - 1];
+            }
+            position--;
+        }
+        if (position < max_sections) {
+            sections[position] = i;
+        }
+    }
+    return num_sections;
+}
+
+const char *profiler_section_name(int section)
+{
+    if (section < PROFILER_SECTION_DAY) {
+        return game_tick_subsystem_name(section - PROFILER_SECTION_TICK);
+    }
+    if (section < PROFILER_SECTION_FIGURE_TYPE) {
+        return SECTION_NAMES[section - PROFILER_SECTION_DAY];
+    }
+    int type = section - PROFILER_SECTION_FIGURE_TYPE;
+    if (!data.figure_type_names[type][0]) {
+        snprintf(data.figure_type_names[type], sizeof(data.figure_type_names[type]), "figure_type_%d", type);
+    }
+    return data.figure_type_names[type];
+}
+
+double profiler_to_millis(uint64_t time)
+{
+    if (!data.frequency) {
+        return 0;
+    }
+    return time * 1000.0 / data.frequency;
+}
@@ -0,0 +1,117 @@
+#ifndef GAME_PROFILER_H
+#define GAME_PROFILER_H
+
+#include "figure/type.h"
+
+#include <stdint.h>
+
+/**
+ * @file
+ * Wall time measurement of the simulation subsystems.
+ * Measuring is disabled until a clock is set, so sections are cheap to mark.
+ */
+
+#define PROFILER_TICKS_PER_DAY 50
+#define PROFILER_HISTOGRAM_BUCKETS 16
+
+typedef enum {
+    PROFILER_SECTION_TICK = 0, // one section for each tick of a day, see game_tick_subsystem_name
+    PROFILER_SECTION_DAY = PROFILER_SECTION_TICK + PROFILER_TICKS_PER_DAY,
+    PROFILER_SECTION_MONTH,
+    PROFILER_SECTION_YEAR,
+    PROFILER_SECTION_FIGURE_ACTIONS,
+    PROFILER_SECTION_SCENARIO_EVENTS,
+    PROFILER_SECTION_GAME_TICK,
+    PROFILER_SECTION_FIGURE_TYPE, // one section for each figure type's action
+    PROFILER_SECTION_MAX = PROFILER_SECTION_FIGURE_TYPE + FIGURE_TYPE_MAX
+} profiler_section;
+
+typedef struct {
+    int calls;
+    uint64_t total_time;
+    uint64_t max_time;
+} profiler_stats;
+
+/**
+ * Sets the clock used for measurements
+ * @param clock Function returning a monotonic time, or 0 to disable measuring
+ * @param frequency Number of clock units in a second
+ */
+void profiler_set_clock(uint64_t (*clock)(void), uint64_t frequency);
+
+/**
+ * @return Whether measurements are being taken
+ */
+int profiler_is_enabled(void);
+
+/**
+ * Starts measuring a section
+ * @param section Section to measure
+ */
+void profiler_start(int section);
+
+/**
+ * Stops measuring a section and adds the elapsed time to its stats
+ * @param section Section to measure
+ */
+void profiler_stop(int section);
+
+/**
+ * Marks the end of a game tick. The time a section took during the tick is added to its
+ * rolling histogram, which covers the last few game days.
+ */
+void profiler_end_tick(void);
+
+/**
+ * Clears the stats of all sections
+ */
+void profiler_reset(void);
+
+/**
+ * Gets the stats of a section
+ * @param section Section
+ * @return Stats, times are in clock units
+ */
+const profiler_stats *profiler_get_stats(int section);
+
+/**
+ * Gets the number of recent ticks that fall in a histogram bucket of a section.
+ * Bucket N holds the ticks during which the section took less than 2^N microseconds,
+ * the last bucket also holds all slower ticks.
+ * @param section Section
+ * @param bucket Bucket, 0 to PROFILER_HISTOGRAM_BUCKETS - 1
+ * @return Number of ticks
+ */
+int profiler_get_histogram(int section, int bucket);
+
+/**
+ * Gets the longest time a section took during a single recent tick
+ * @param section Section
+ * @return Time in clock units
+ */
+uint64_t profiler_get_recent_max(int section);
+
+/**
+ * Gets the sections that took the longest during a single recent tick,
+ * leaving out sections that only group other sections
+ * @param sections Array to store the sections in, slowest first
+ * @param max_sections Size of the array
+ * @return Number of sections stored
+ */
+int profiler_get_worst_sections(int *sections, int max_sections);
+
+/**
+ * Gets a name for a section
+ * @param section Section
+ * @return Section name
+ */
+const char *profiler_section_name(int section);
+
+/**
+ * Converts clock units to milliseconds
+ * @param time Time in clock units
+ * @return Time in milliseconds
+ */
+double profiler_to_millis(uint64_t time);
+
+#endif // GAME_PROFILER_H
@@ -29,12 +29,14 @@
 #include "city/sentiment.h"
 #include "city/trade.h"
 #include "city/victory.h"
+#include "city/warning.h"
 #include "core/random.h"
 #include "editor/editor.h"
 #include "empire/city.h"
 #include "figure/formation.h"
 #include "figuretype/crime.h"
 #include "game/file.h"
+#include "game/profiler.h"
 #include "game/settings.h"
 #include "game/time.h"
 #include "game/tutorial.h"
@@ -42,6 +44,7 @@
 #include "map/desirability.h"
 #include "map/natives.h"
 #include "map/road_network.h"
+#include "map/routing.h"
 #include "map/routing_terrain.h"
 #include "map/tiles.h"
 #include "map/water_supply.h"
@@ -58,6 +61,59 @@
 #include "sound/music.h"
 #include "widget/minimap.h"
 
+static const char *TICK_SUBSYSTEM_NAMES[PROFILER_TICKS_PER_DAY] = {
+    "tick_0",
+    "city_gods_calculate_moods",
+    "sound_music_update",
+    "widget_minimap_invalidate",
+    "city_emperor_update",
+    "formation_update_all",
+    "map_natives_check_land",
+    "map_road_network_update",
+    "building_granaries_calculate_stocks",
+    "tick_9",
+    "tick_10",
+    "tick_11",
+    "house_service_decay_houses_covered",
+    "tick_13",
+    "tick_14",
+    "tick_15",
+    "city_resource_calculate_warehouse_stocks",
+    "city_resource_calculate_food_stocks_and_supply_wheat",
+    "city_resource_calculate_workshop_stocks",
+    "building_dock_update_open_water_access",
+    "building_industry_update_production",
+    "building_maintenance_check_rome_access",
+    "house_population_update_room",
+    "house_population_update_migration",
+    "house_population_evict_overcrowded",
+    "city_labor_update",
+    "tick_26",
+    "map_water_supply_update_reservoir_fountain",
+    "map_water_supply_update_houses",
+    "formation_update_all_second_time",
+    "widget_minimap_invalidate_second_time",
+    "building_figure_generate",
+    "city_trade_update",
+    "building_count_update",
+    "building_government_distribute_treasury",
+    "house_service_decay_culture",
+    "house_service_calculate_culture_aggregates",
+    "map_desirability_update",
+    "building_update_desirability",
+    "building_house_process_evolve_and_consume_goods",
+    "building_update_state",
+    "tick_41",
+    "city_finance_spawn_tourist",
+    "building_maintenance_update_burning_ruins",
+    "building_maintenance_check_fire_collapse",
+    "figure_generate_criminals",
+    "building_industry_update_wheat_production",
+    "city_games_decrement_duration",
+    "house_service_decay_tax_collector",
+    "city_culture_calculate"
+};
+
 static void advance_year(void)
 {
     game_undo_disable();
@@ -70,6 +126,13 @@ static void advance_year(void)
     city_ratings_update(1,0);
 }
 
+static void autosave_finished(int success)
+{
+    if (!success) {
+        city_warning_show(WARNING_AUTOSAVE_FAILED);
+    }
+}
+
 static void advance_month(void)
 {
     city_migration_reset_newcomers();
@@ -96,7 +159,9 @@ static void advance_month(void)
     city_message_sort_and_compact();
 
     if (game_time_advance_month()) {
+        profiler_start(PROFILER_SECTION_YEAR);
         advance_year();
+        profiler_stop(PROFILER_SECTION_YEAR);
     } else {
         city_ratings_update(0,1);
     }
@@ -107,14 +172,16 @@ static void advance_month(void)
     city_gods_update_blessings();
     tutorial_on_month_tick();
     if (setting_monthly_autosave()) {
-        game_file_write_saved_game("autosave.svx");
+        game_file_write_saved_game_in_background("autosave.svx", autosave_finished);
     }
 }
 
 static void advance_day(void)
 {
     if (game_time_advance_day()) {
+        profiler_start(PROFILER_SECTION_MONTH);
         advance_month();
+        profiler_stop(PROFILER_SECTION_MONTH);
     }
     if (game_time_day() == 0 || game_time_day() == 8) {
         city_sentiment_update();
@@ -129,7 +196,9 @@ static void advance_tick(void)
 {
     // NB: these ticks are noop:
     // 0, 9, 10, 11, 13, 14, 15, 26, 41, 42, 47
-    switch (game_time_tick()) {
+    int tick = game_time_tick();
+    profiler_start(PROFILER_SECTION_TICK + tick);
+    switch (tick) {
         case 1: city_gods_calculate_moods(1); break;
         case 2: sound_music_update(0); break;
         case 3: widget_minimap_invalidate(); break;
@@ -172,8 +241,11 @@ static void advance_tick(void)
         case 48: house_service_decay_tax_collector(); break;
         case 49: city_culture_calculate(); break;
     }
+    profiler_stop(PROFILER_SECTION_TICK + tick);
     if (game_time_advance_tick()) {
+        profiler_start(PROFILER_SECTION_DAY);
         advance_day();
+        profiler_stop(PROFILER_SECTION_DAY);
     }
 }
 
@@ -184,17 +256,30 @@ void game_tick_run(void)
         figure_action_handle(); // just update the flag figures
         return;
     }
+    profiler_start(PROFILER_SECTION_GAME_TICK);
     random_generate_next();
     game_undo_reduce_time_available();
+    map_routing_reset_tick_stats();
     advance_tick();
+    profiler_start(PROFILER_SECTION_FIGURE_ACTIONS);
     figure_action_handle();
+    profiler_stop(PROFILER_SECTION_FIGURE_ACTIONS);
+    profiler_start(PROFILER_SECTION_SCENARIO_EVENTS);
     scenario_earthquake_process();
     scenario_gladiator_revolt_process();
     scenario_emperor_change_process();
     city_victory_check();
+    profiler_stop(PROFILER_SECTION_SCENARIO_EVENTS);
+    profiler_stop(PROFILER_SECTION_GAME_TICK);
+    profiler_end_tick();
 }
 
 void game_tick_cheat_year(void)
 {
     advance_year();
 }
+
+const char *game_tick_subsystem_name(int tick)
+{
+    return TICK_SUBSYSTEM_NAMES[tick];
+}
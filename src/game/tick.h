@@ -5,4 +5,11 @@ void game_tick_run(void);
 
 void game_tick_cheat_year(void);
 
+/**
+ * Gets the name of the subsystem that is updated on a tick of the day
+ * @param tick Tick of the day, 0-49
+ * @return Subsystem name
+ */
+const char *game_tick_subsystem_name(int tick);
+
 #endif // GAME_TICK_H
@@ -0,0 +1,565 @@
+#include "blend.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_SSE2_KERNELS
+#define HAS_AVX2_KERNELS
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAS_SSE2_KERNELS
+#define TARGET_SSE2
+#ifdef __AVX2__
+#define HAS_AVX2_KERNELS
+#define TARGET_AVX2
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAS_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+typedef struct {
+    void (*and_color)(color_t *dst, int num_pixels, color_t color);
+    void (*color_alpha)(color_t *dst, int num_pixels, color_t color);
+    void (*mask)(color_t *dst, const color_t *src, int num_pixels, color_t mask);
+    void (*mask_alpha)(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha);
+    void (*src_alpha)(color_t *dst, const color_t *src, int num_pixels);
+    void (*shade)(color_t *dst, int num_pixels, int darkness);
+} kernel_set;
+
+static void scalar_and(color_t *dst, int num_pixels, color_t color)
+{
+    for (int i = 0; i < num_pixels; i++) {
+        dst[i] &= color;
+    }
+}
+
+static void scalar_color_alpha(color_t *dst, int num_pixels, color_t color)
+{
+    color_t alpha = COLOR_COMPONENT(color, COLOR_BITSHIFT_ALPHA);
+    color_t alpha_dst = 256 - alpha;
+    color_t src_rb = (color & COLOR_CHANNEL_RB) * alpha;
+    color_t src_g = (color & COLOR_CHANNEL_GREEN) * alpha;
+    for (int i = 0; i < num_pixels; i++) {
+        color_t d = dst[i];
+        dst[i] = (((src_rb + (d & COLOR_CHANNEL_RB) * alpha_dst) & ((color_t) COLOR_CHANNEL_RB << 8)) |
+            ((src_g + (d & COLOR_CHANNEL_GREEN) * alpha_dst) & ((color_t) COLOR_CHANNEL_GREEN << 8))) >> 8;
+    }
+}
+
+static void scalar_mask(color_t *dst, const color_t *src, int num_pixels, color_t mask)
+{
+    for (int i = 0; i < num_pixels; i++) {
+        dst[i] = src[i] & mask;
+    }
+}
+
+static void scalar_mask_alpha(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha)
+{
+    for (int i = 0; i < num_pixels; i++) {
+        dst[i] = COLOR_BLEND_ALPHA_TO_OPAQUE(src[i] & mask, dst[i], alpha);
+    }
+}
+
+static void scalar_src_alpha(color_t *dst, const color_t *src, int num_pixels)
+{
+    for (int i = 0; i < num_pixels; i++) {
+        color_t alpha = src[i] & COLOR_CHANNEL_ALPHA;
+        if (alpha == ALPHA_OPAQUE) {
+            dst[i] = src[i];
+        } else if (alpha != ALPHA_TRANSPARENT) {
+            dst[i] = COLOR_BLEND_ALPHA_TO_OPAQUE(src[i], dst[i], alpha >> COLOR_BITSHIFT_ALPHA);
+        }
+    }
+}
+
+static void scalar_shade(color_t *dst, int num_pixels, int darkness)
+{
+    for (int i = 0; i < num_pixels; i++) {
+        int r = (dst[i] & 0xff0000) >> 16;
+        int g = (dst[i] & 0xff00) >> 8;
+        int b = (dst[i] & 0xff);
+        int grey = (r + g + b) / 3 >> darkness;
+        dst[i] = (color_t) (ALPHA_OPAQUE | grey << 16 | grey << 8 | grey);
+    }
+}
+
+static const kernel_set SCALAR_KERNELS = {
+    scalar_and, scalar_color_alpha, scalar_mask, scalar_mask_alpha, scalar_src_alpha, scalar_shade
+};
+
+// The vector kernels work on 16-bit channels: every blend fits, since 255 * 256 < 65536.
+// Division by 3 of a sum of three channels is done as (sum * 0xaaab) >> 17, which is exact up to 765.
+
+#ifdef HAS_SSE2_KERNELS
+TARGET_SSE2 static void sse2_and(color_t *dst, int num_pixels, color_t color)
+{
+    __m128i c = _mm_set1_epi32((int) color);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        __m128i *p = (__m128i *) &dst[i];
+        _mm_storeu_si128(p, _mm_and_si128(_mm_loadu_si128(p), c));
+    }
+    scalar_and(&dst[i], num_pixels - i, color);
+}
+
+TARGET_SSE2 static void sse2_color_alpha(color_t *dst, int num_pixels, color_t color)
+{
+    color_t alpha = COLOR_COMPONENT(color, COLOR_BITSHIFT_ALPHA);
+    __m128i zero = _mm_setzero_si128();
+    __m128i alpha_dst = _mm_set1_epi16((short) (256 - alpha));
+    __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int) (color & ~COLOR_CHANNEL_ALPHA)), zero),
+        _mm_set1_epi16((short) alpha));
+    __m128i channels = _mm_set1_epi32((int) ~COLOR_CHANNEL_ALPHA);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        __m128i *p = (__m128i *) &dst[i];
+        __m128i d = _mm_loadu_si128(p);
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), alpha_dst), src), 8);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), alpha_dst), src), 8);
+        _mm_storeu_si128(p, _mm_and_si128(_mm_packus_epi16(lo, hi), channels));
+    }
+    scalar_color_alpha(&dst[i], num_pixels - i, color);
+}
+
+TARGET_SSE2 static void sse2_mask(color_t *dst, const color_t *src, int num_pixels, color_t mask)
+{
+    __m128i m = _mm_set1_epi32((int) mask);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *) &src[i]);
+        _mm_storeu_si128((__m128i *) &dst[i], _mm_and_si128(s, m));
+    }
+    scalar_mask(&dst[i], &src[i], num_pixels - i, mask);
+}
+
+TARGET_SSE2 static void sse2_mask_alpha(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i m = _mm_set1_epi32((int) mask);
+    __m128i alpha_src = _mm_set1_epi16((short) alpha);
+    __m128i alpha_dst = _mm_set1_epi16((short) (0xff - alpha));
+    __m128i opaque = _mm_set1_epi32((int) ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        __m128i *p = (__m128i *) &dst[i];
+        __m128i s = _mm_and_si128(_mm_loadu_si128((const __m128i *) &src[i]), m);
+        __m128i d = _mm_loadu_si128(p);
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), alpha_src),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), alpha_dst)), 8);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), alpha_src),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), alpha_dst)), 8);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+    }
+    scalar_mask_alpha(&dst[i], &src[i], num_pixels - i, mask, alpha);
+}
+
+TARGET_SSE2 static __m128i sse2_blend_pixels(__m128i s, __m128i d, __m128i zero, __m128i max)
+{
+    __m128i s16 = _mm_unpacklo_epi8(s, zero);
+    __m128i alpha_src = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xff), 0xff);
+    __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(s16, alpha_src),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(max, alpha_src))), 8);
+    s16 = _mm_unpackhi_epi8(s, zero);
+    alpha_src = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xff), 0xff);
+    __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(s16, alpha_src),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(max, alpha_src))), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+TARGET_SSE2 static void sse2_src_alpha(color_t *dst, const color_t *src, int num_pixels)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i max = _mm_set1_epi16(0xff);
+    __m128i opaque = _mm_set1_epi32((int) ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        __m128i *p = (__m128i *) &dst[i];
+        __m128i s = _mm_loadu_si128((const __m128i *) &src[i]);
+        __m128i d = _mm_loadu_si128(p);
+        __m128i alpha = _mm_and_si128(s, opaque);
+        __m128i is_opaque = _mm_cmpeq_epi32(alpha, opaque);
+        __m128i is_transparent = _mm_cmpeq_epi32(alpha, zero);
+        __m128i result = _mm_or_si128(sse2_blend_pixels(s, d, zero, max), opaque);
+        result = _mm_or_si128(_mm_and_si128(is_opaque, s), _mm_andnot_si128(is_opaque, result));
+        result = _mm_or_si128(_mm_and_si128(is_transparent, d), _mm_andnot_si128(is_transparent, result));
+        _mm_storeu_si128(p, result);
+    }
+    scalar_src_alpha(&dst[i], &src[i], num_pixels - i);
+}
+
+TARGET_SSE2 static void sse2_shade(color_t *dst, int num_pixels, int darkness)
+{
+    __m128i channel = _mm_set1_epi32(0xff);
+    __m128i third = _mm_set1_epi32(0xaaab);
+    __m128i shift = _mm_cvtsi32_si128(darkness);
+    __m128i opaque = _mm_set1_epi32((int) ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        __m128i *p = (__m128i *) &dst[i];
+        __m128i d = _mm_loadu_si128(p);
+        __m128i sum = _mm_add_epi32(_mm_and_si128(d, channel),
+            _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(d, 8), channel), _mm_and_si128(_mm_srli_epi32(d, 16), channel)));
+        __m128i grey = _mm_srl_epi32(_mm_srli_epi32(_mm_mulhi_epu16(sum, third), 1), shift);
+        grey = _mm_or_si128(grey, _mm_or_si128(_mm_slli_epi32(grey, 8), _mm_slli_epi32(grey, 16)));
+        _mm_storeu_si128(p, _mm_or_si128(grey, opaque));
+    }
+    scalar_shade(&dst[i], num_pixels - i, darkness);
+}
+
+static const kernel_set SSE2_KERNELS = {
+    sse2_and, sse2_color_alpha, sse2_mask, sse2_mask_alpha, sse2_src_alpha, sse2_shade
+};
+#endif
+
+#ifdef HAS_AVX2_KERNELS
+TARGET_AVX2 static void avx2_and(color_t *dst, int num_pixels, color_t color)
+{
+    __m256i c = _mm256_set1_epi32((int) color);
+    int i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i *p = (__m256i *) &dst[i];
+        _mm256_storeu_si256(p, _mm256_and_si256(_mm256_loadu_si256(p), c));
+    }
+    sse2_and(&dst[i], num_pixels - i, color);
+}
+
+TARGET_AVX2 static void avx2_color_alpha(color_t *dst, int num_pixels, color_t color)
+{
+    color_t alpha = COLOR_COMPONENT(color, COLOR_BITSHIFT_ALPHA);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i alpha_dst = _mm256_set1_epi16((short) (256 - alpha));
+    __m256i src = _mm256_mullo_epi16(
+        _mm256_unpacklo_epi8(_mm256_set1_epi32((int) (color & ~COLOR_CHANNEL_ALPHA)), zero),
+        _mm256_set1_epi16((short) alpha));
+    __m256i channels = _mm256_set1_epi32((int) ~COLOR_CHANNEL_ALPHA);
+    int i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i *p = (__m256i *) &dst[i];
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i lo = _mm256_srli_epi16(
+            _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), alpha_dst), src), 8);
+        __m256i hi = _mm256_srli_epi16(
+            _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), alpha_dst), src), 8);
+        _mm256_storeu_si256(p, _mm256_and_si256(_mm256_packus_epi16(lo, hi), channels));
+    }
+    sse2_color_alpha(&dst[i], num_pixels - i, color);
+}
+
+TARGET_AVX2 static void avx2_mask(color_t *dst, const color_t *src, int num_pixels, color_t mask)
+{
+    __m256i m = _mm256_set1_epi32((int) mask);
+    int i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *) &src[i]);
+        _mm256_storeu_si256((__m256i *) &dst[i], _mm256_and_si256(s, m));
+    }
+    sse2_mask(&dst[i], &src[i], num_pixels - i, mask);
+}
+
+TARGET_AVX2 static void avx2_mask_alpha(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i m = _mm256_set1_epi32((int) mask);
+    __m256i alpha_src = _mm256_set1_epi16((short) alpha);
+    __m256i alpha_dst = _mm256_set1_epi16((short) (0xff - alpha));
+    __m256i opaque = _mm256_set1_epi32((int) ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i *p = (__m256i *) &dst[i];
+        __m256i s = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) &src[i]), m);
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i lo = _mm256_srli_epi16(_mm256_add_epi16(
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), alpha_src),
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), alpha_dst)), 8);
+        __m256i hi = _mm256_srli_epi16(_mm256_add_epi16(
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), alpha_src),
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), alpha_dst)), 8);
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+    }
+    sse2_mask_alpha(&dst[i], &src[i], num_pixels - i, mask, alpha);
+}
+
+TARGET_AVX2 static void avx2_src_alpha(color_t *dst, const color_t *src, int num_pixels)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i max = _mm256_set1_epi16(0xff);
+    __m256i opaque = _mm256_set1_epi32((int) ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i *p = (__m256i *) &dst[i];
+        __m256i s = _mm256_loadu_si256((const __m256i *) &src[i]);
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i s16 = _mm256_unpacklo_epi8(s, zero);
+        __m256i alpha_src = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s16, 0xff), 0xff);
+        __m256i lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s16, alpha_src),
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(max, alpha_src))), 8);
+        s16 = _mm256_unpackhi_epi8(s, zero);
+        alpha_src = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s16, 0xff), 0xff);
+        __m256i hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s16, alpha_src),
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(max, alpha_src))), 8);
+        __m256i alpha = _mm256_and_si256(s, opaque);
+        __m256i result = _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque);
+        result = _mm256_blendv_epi8(result, s, _mm256_cmpeq_epi32(alpha, opaque));
+        result = _mm256_blendv_epi8(result, d, _mm256_cmpeq_epi32(alpha, zero));
+        _mm256_storeu_si256(p, result);
+    }
+    sse2_src_alpha(&dst[i], &src[i], num_pixels - i);
+}
+
+TARGET_AVX2 static void avx2_shade(color_t *dst, int num_pixels, int darkness)
+{
+    __m256i channel = _mm256_set1_epi32(0xff);
+    __m256i third = _mm256_set1_epi32(0xaaab);
+    __m128i shift = _mm_cvtsi32_si128(darkness);
+    __m256i opaque = _mm256_set1_epi32((int) ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i *p = (__m256i *) &dst[i];
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i sum = _mm256_add_epi32(_mm256_and_si256(d, channel), _mm256_add_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(d, 8), channel), _mm256_and_si256(_mm256_srli_epi32(d, 16), channel)));
+        __m256i grey = _mm256_srl_epi32(_mm256_srli_epi32(_mm256_mulhi_epu16(sum, third), 1), shift);
+        grey = _mm256_or_si256(grey, _mm256_or_si256(_mm256_slli_epi32(grey, 8), _mm256_slli_epi32(grey, 16)));
+        _mm256_storeu_si256(p, _mm256_or_si256(grey, opaque));
+    }
+    sse2_shade(&dst[i], num_pixels - i, darkness);
+}
+
+static const kernel_set AVX2_KERNELS = {
+    avx2_and, avx2_color_alpha, avx2_mask, avx2_mask_alpha, avx2_src_alpha, avx2_shade
+};
+#endif
+
+#ifdef HAS_NEON_KERNELS
+static uint16x8_t neon_blend_channels(uint8x8_t src, uint16x8_t alpha_src, uint8x8_t dst, uint16x8_t alpha_dst)
+{
+    return vshrq_n_u16(vaddq_u16(vmulq_u16(vmovl_u8(src), alpha_src), vmulq_u16(vmovl_u8(dst), alpha_dst)), 8);
+}
+
+static void neon_and(color_t *dst, int num_pixels, color_t color)
+{
+    uint32x4_t c = vdupq_n_u32(color);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        vst1q_u32(&dst[i], vandq_u32(vld1q_u32(&dst[i]), c));
+    }
+    scalar_and(&dst[i], num_pixels - i, color);
+}
+
+static void neon_color_alpha(color_t *dst, int num_pixels, color_t color)
+{
+    color_t alpha = COLOR_COMPONENT(color, COLOR_BITSHIFT_ALPHA);
+    uint16x8_t alpha_dst = vdupq_n_u16((uint16_t) (256 - alpha));
+    uint16x8_t src = vmulq_n_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(color & ~COLOR_CHANNEL_ALPHA))),
+        (uint16_t) alpha);
+    uint32x4_t channels = vdupq_n_u32(~COLOR_CHANNEL_ALPHA);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(&dst[i]));
+        uint16x8_t lo = vshrq_n_u16(vaddq_u16(vmulq_u16(vmovl_u8(vget_low_u8(d)), alpha_dst), src), 8);
+        uint16x8_t hi = vshrq_n_u16(vaddq_u16(vmulq_u16(vmovl_u8(vget_high_u8(d)), alpha_dst), src), 8);
+        uint32x4_t result = vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+        vst1q_u32(&dst[i], vandq_u32(result, channels));
+    }
+    scalar_color_alpha(&dst[i], num_pixels - i, color);
+}
+
+static void neon_mask(color_t *dst, const color_t *src, int num_pixels, color_t mask)
+{
+    uint32x4_t m = vdupq_n_u32(mask);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        vst1q_u32(&dst[i], vandq_u32(vld1q_u32(&src[i]), m));
+    }
+    scalar_mask(&dst[i], &src[i], num_pixels - i, mask);
+}
+
+static void neon_mask_alpha(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha)
+{
+    uint32x4_t m = vdupq_n_u32(mask);
+    uint16x8_t alpha_src = vdupq_n_u16((uint16_t) alpha);
+    uint16x8_t alpha_dst = vdupq_n_u16((uint16_t) (0xff - alpha));
+    uint32x4_t opaque = vdupq_n_u32(ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        uint8x16_t s = vreinterpretq_u8_u32(vandq_u32(vld1q_u32(&src[i]), m));
+        uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(&dst[i]));
+        uint16x8_t lo = neon_blend_channels(vget_low_u8(s), alpha_src, vget_low_u8(d), alpha_dst);
+        uint16x8_t hi = neon_blend_channels(vget_high_u8(s), alpha_src, vget_high_u8(d), alpha_dst);
+        uint32x4_t result = vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+        vst1q_u32(&dst[i], vorrq_u32(result, opaque));
+    }
+    scalar_mask_alpha(&dst[i], &src[i], num_pixels - i, mask, alpha);
+}
+
+static void neon_src_alpha(color_t *dst, const color_t *src, int num_pixels)
+{
+    uint32x4_t opaque = vdupq_n_u32(ALPHA_OPAQUE);
+    uint32x4_t zero = vdupq_n_u32(0);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        uint32x4_t s = vld1q_u32(&src[i]);
+        uint32x4_t d = vld1q_u32(&dst[i]);
+        uint8x16_t alpha_src = vreinterpretq_u8_u32(vmulq_n_u32(vshrq_n_u32(s, 24), 0x01010101));
+        uint8x16_t alpha_dst = vmvnq_u8(alpha_src);
+        uint8x16_t s8 = vreinterpretq_u8_u32(s);
+        uint8x16_t d8 = vreinterpretq_u8_u32(d);
+        uint16x8_t lo = neon_blend_channels(vget_low_u8(s8), vmovl_u8(vget_low_u8(alpha_src)),
+            vget_low_u8(d8), vmovl_u8(vget_low_u8(alpha_dst)));
+        uint16x8_t hi = neon_blend_channels(vget_high_u8(s8), vmovl_u8(vget_high_u8(alpha_src)),
+            vget_high_u8(d8), vmovl_u8(vget_high_u8(alpha_dst)));
+        uint32x4_t result = vorrq_u32(vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi))), opaque);
+        uint32x4_t alpha = vandq_u32(s, opaque);
+        result = vbslq_u32(vceqq_u32(alpha, opaque), s, result);
+        result = vbslq_u32(vceqq_u32(alpha, zero), d, result);
+        vst1q_u32(&dst[i], result);
+    }
+    scalar_src_alpha(&dst[i], &src[i], num_pixels - i);
+}
+
+static void neon_shade(color_t *dst, int num_pixels, int darkness)
+{
+    uint32x4_t channel = vdupq_n_u32(0xff);
+    int32x4_t shift = vdupq_n_s32(-darkness);
+    uint32x4_t opaque = vdupq_n_u32(ALPHA_OPAQUE);
+    int i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        uint32x4_t d = vld1q_u32(&dst[i]);
+        uint32x4_t sum = vaddq_u32(vandq_u32(d, channel),
+            vaddq_u32(vandq_u32(vshrq_n_u32(d, 8), channel), vandq_u32(vshrq_n_u32(d, 16), channel)));
+        uint32x4_t grey = vshlq_u32(vshrq_n_u32(vmulq_n_u32(sum, 0xaaab), 17), shift);
+        vst1q_u32(&dst[i], vorrq_u32(vmulq_n_u32(grey, 0x010101), opaque));
+    }
+    scalar_shade(&dst[i], num_pixels - i, darkness);
+}
+
+static const kernel_set NEON_KERNELS = {
+    neon_and, neon_color_alpha, neon_mask, neon_mask_alpha, neon_src_alpha, neon_shade
+};
+#endif
+
+static struct {
+    int selected;
+    blend_kernels type;
+    const kernel_set *kernels;
+} data;
+
+int blend_kernels_supported(blend_kernels kernels)
+{
+    switch (kernels) {
+        case BLEND_KERNELS_SCALAR:
+            return 1;
+#ifdef HAS_SSE2_KERNELS
+        case BLEND_KERNELS_SSE2:
+#if defined(__GNUC__) && defined(__i386__)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+#else
+            return 1;
+#endif
+#endif
+#ifdef HAS_AVX2_KERNELS
+        case BLEND_KERNELS_AVX2:
+#ifdef __GNUC__
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+            return 1;
+#endif
+#endif
+#ifdef HAS_NEON_KERNELS
+        case BLEND_KERNELS_NEON:
+            return 1;
+#endif
+        default:
+            return 0;
+    }
+}
+
+int blend_set_kernels(blend_kernels kernels)
+{
+    if (!blend_kernels_supported(kernels)) {
+        return 0;
+    }
+    switch (kernels) {
+#ifdef HAS_SSE2_KERNELS
+        case BLEND_KERNELS_SSE2:
+            data.kernels = &SSE2_KERNELS;
+            break;
+#endif
+#ifdef HAS_AVX2_KERNELS
+        case BLEND_KERNELS_AVX2:
+            data.kernels = &AVX2_KERNELS;
+            break;
+#endif
+#ifdef HAS_NEON_KERNELS
+        case BLEND_KERNELS_NEON:
+            data.kernels = &NEON_KERNELS;
+            break;
+#endif
+        default:
+            data.kernels = &SCALAR_KERNELS;
+            break;
+    }
+    data.type = kernels;
+    data.selected = 1;
+    return 1;
+}
+
+static void select_best_kernels(void)
+{
+    if (!blend_set_kernels(BLEND_KERNELS_AVX2) && !blend_set_kernels(BLEND_KERNELS_SSE2) &&
+        !blend_set_kernels(BLEND_KERNELS_NEON)) {
+        blend_set_kernels(BLEND_KERNELS_SCALAR);
+    }
+}
+
+static const kernel_set *kernels(void)
+{
+    if (!data.selected) {
+        select_best_kernels();
+    }
+    return data.kernels;
+}
+
+blend_kernels blend_get_kernels(void)
+{
+    kernels();
+    return data.type;
+}
+
+void blend_and(color_t *dst, int num_pixels, color_t color)
+{
+    kernels()->and_color(dst, num_pixels, color);
+}
+
+void blend_color_alpha(color_t *dst, int num_pixels, color_t color)
+{
+    kernels()->color_alpha(dst, num_pixels, color);
+}
+
+void blend_mask(color_t *dst, const color_t *src, int num_pixels, color_t mask)
+{
+    kernels()->mask(dst, src, num_pixels, mask);
+}
+
+void blend_mask_alpha(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha)
+{
+    kernels()->mask_alpha(dst, src, num_pixels, mask, alpha);
+}
+
+void blend_src_alpha(color_t *dst, const color_t *src, int num_pixels)
+{
+    kernels()->src_alpha(dst, src, num_pixels);
+}
+
+void blend_shade(color_t *dst, int num_pixels, int darkness)
+{
+    kernels()->shade(dst, num_pixels, darkness);
+}
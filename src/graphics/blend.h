@@ -0,0 +1,37 @@
+#ifndef GRAPHICS_BLEND_H
+#define GRAPHICS_BLEND_H
+
+#include "graphics/color.h"
+
+typedef enum {
+    BLEND_KERNELS_SCALAR = 0,
+    BLEND_KERNELS_SSE2 = 1,
+    BLEND_KERNELS_AVX2 = 2,
+    BLEND_KERNELS_NEON = 3,
+    BLEND_KERNELS_MAX = 4
+} blend_kernels;
+
+// The best kernels the CPU supports are picked the first time a blend function is called
+int blend_kernels_supported(blend_kernels kernels);
+int blend_set_kernels(blend_kernels kernels);
+blend_kernels blend_get_kernels(void);
+
+// dst = dst & color
+void blend_and(color_t *dst, int num_pixels, color_t color);
+
+// dst = color blended over dst using the alpha of color, with alpha 0 in the result
+void blend_color_alpha(color_t *dst, int num_pixels, color_t color);
+
+// dst = src & mask
+void blend_mask(color_t *dst, const color_t *src, int num_pixels, color_t mask);
+
+// dst = COLOR_BLEND_ALPHA_TO_OPAQUE(src & mask, dst, alpha)
+void blend_mask_alpha(color_t *dst, const color_t *src, int num_pixels, color_t mask, color_t alpha);
+
+// dst = src blended over dst using the alpha of each src pixel, fully transparent pixels are skipped
+void blend_src_alpha(color_t *dst, const color_t *src, int num_pixels);
+
+// dst = opaque grey of the average of the channels of dst, darkened by shifting right
+void blend_shade(color_t *dst, int num_pixels, int darkness);
+
+#endif // GRAPHICS_BLEND_H
@@ -0,0 +1,204 @@
+#include "draw_list.h"
+
+#include "core/image.h"
+#include "core/thread_pool.h"
+#include "graphics/blend.h"
+#include "graphics/graphics.h"
+#include "graphics/image.h"
+
+#include <stdlib.h>
+
+#define COMMANDS_SIZE_STEP 4096
+#define BANDS_PER_THREAD 2
+#define MIN_BAND_HEIGHT 32
+
+typedef struct {
+    draw_list_type type;
+    int image_id;
+    int x;
+    int y;
+    color_t color;
+    font_t font;
+    double scale;
+} draw_command;
+
+static struct {
+    int is_recording;
+    int draw_serially;
+    draw_command *commands;
+    int num_commands;
+    int capacity;
+    struct {
+        int x;
+        int y;
+        int width;
+        int height;
+        int band_height;
+    } area;
+} data;
+
+static void draw_command_now(const draw_command *command)
+{
+    switch (command->type) {
+        case DRAW_LIST_IMAGE:
+            image_draw(command->image_id, command->x, command->y);
+            break;
+        case DRAW_LIST_ENEMY:
+            image_draw_enemy(command->image_id, command->x, command->y);
+            break;
+        case DRAW_LIST_MASKED:
+            image_draw_masked(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_BLEND:
+            image_draw_blend(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_BLEND_ALPHA:
+            image_draw_blend_alpha(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_LETTER:
+            image_draw_letter(command->font, command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_ISOMETRIC_FOOTPRINT:
+            image_draw_isometric_footprint(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_ISOMETRIC_FOOTPRINT_FROM_DRAW_TILE:
+            image_draw_isometric_footprint_from_draw_tile(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_ISOMETRIC_TOP:
+            image_draw_isometric_top(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_ISOMETRIC_TOP_FROM_DRAW_TILE:
+            image_draw_isometric_top_from_draw_tile(command->image_id, command->x, command->y, command->color);
+            break;
+        case DRAW_LIST_SCALED:
+            image_draw_scaled(command->image_id, command->x, command->y, command->scale);
+            break;
+    }
+}
+
+static void draw_all_commands(void)
+{
+    for (int i = 0; i < data.num_commands; i++) {
+        draw_command_now(&data.commands[i]);
+    }
+}
+
+static void draw_band(int index, void *userdata)
+{
+    int y = data.area.y + index * data.area.band_height;
+    int height = data.area.band_height;
+    if (y + height > data.area.y + data.area.height) {
+        height = data.area.y + data.area.height - y;
+    }
+    graphics_set_clip_rectangle(data.area.x, y, data.area.width, height);
+    draw_all_commands();
+}
+
+void draw_list_begin(void)
+{
+#ifdef THREAD_POOL_HAS_THREAD_LOCAL
+    if (thread_pool_num_threads() < 2) {
+        return;
+    }
+    data.is_recording = 1;
+    data.draw_serially = 0;
+    data.num_commands = 0;
+#endif
+}
+
+void draw_list_end(void)
+{
+    if (!data.is_recording) {
+        return;
+    }
+    data.is_recording = 0;
+    if (data.draw_serially) {
+        draw_all_commands();
+        return;
+    }
+    graphics_get_clip_rectangle(&data.area.x, &data.area.y, &data.area.width, &data.area.height);
+    if (data.area.width <= 0 || data.area.height <= 0) {
+        return;
+    }
+    int num_bands = thread_pool_num_threads() * BANDS_PER_THREAD;
+    if (num_bands > data.area.height / MIN_BAND_HEIGHT) {
+        num_bands = data.area.height / MIN_BAND_HEIGHT;
+    }
+    if (num_bands < 2) {
+        draw_all_commands();
+        return;
+    }
+    data.area.band_height = (data.area.height + num_bands - 1) / num_bands;
+    num_bands = (data.area.height + data.area.band_height - 1) / data.area.band_height;
+
+    // Kernels are picked on first use, which must not happen on several threads at once
+    blend_get_kernels();
+    thread_pool_run(draw_band, num_bands, 0);
+    graphics_set_clip_rectangle(data.area.x, data.area.y, data.area.width, data.area.height);
+}
+
+static draw_command *new_command(void)
+{
+    if (data.num_commands >= data.capacity) {
+        int capacity = data.capacity + COMMANDS_SIZE_STEP;
+        draw_command *commands = realloc(data.commands, capacity * sizeof(draw_command));
+        if (!commands) {
+            // Draw what was recorded so far, and let the caller draw from now on
+            data.is_recording = 0;
+            draw_all_commands();
+            return 0;
+        }
+        data.commands = commands;
+        data.capacity = capacity;
+    }
+    return &data.commands[data.num_commands++];
+}
+
+static void prepare_image(draw_list_type type, int image_id)
+{
+    if (type == DRAW_LIST_ENEMY || type == DRAW_LIST_LETTER) {
+        return;
+    }
+    // External images are loaded into a cache that is not shared between threads
+    if (image_get(image_id)->draw.is_external) {
+        data.draw_serially = 1;
+    }
+    // Loads extra assets now, rather than on several threads at once
+    image_data(image_id);
+}
+
+int draw_list_add(draw_list_type type, int image_id, int x, int y, color_t color)
+{
+    if (!data.is_recording) {
+        return 0;
+    }
+    prepare_image(type, image_id);
+    draw_command *command = new_command();
+    if (!command) {
+        return 0;
+    }
+    command->type = type;
+    command->image_id = image_id;
+    command->x = x;
+    command->y = y;
+    command->color = color;
+    return 1;
+}
+
+int draw_list_add_letter(font_t font, int letter_id, int x, int y, color_t color)
+{
+    if (!draw_list_add(DRAW_LIST_LETTER, letter_id, x, y, color)) {
+        return 0;
+    }
+    data.commands[data.num_commands - 1].font = font;
+    return 1;
+}
+
+int draw_list_add_scaled(int image_id, int x, int y, double scale)
+{
+    if (!draw_list_add(DRAW_LIST_SCALED, image_id, x, y, 0)) {
+        return 0;
+    }
+    data.commands[data.num_commands - 1].scale = scale;
+    return 1;
+}
@@ -0,0 +1,63 @@
+#ifndef GRAPHICS_DRAW_LIST_H
+#define GRAPHICS_DRAW_LIST_H
+
+#include "graphics/color.h"
+#include "graphics/font.h"
+
+/**
+ * @file
+ * Drawing a large number of images on several threads.
+ * While a draw list is recorded, the image_draw functions store their arguments instead of drawing.
+ * When the list ends, the clip rectangle is split into horizontal bands that each draw all images
+ * in the recorded order, so the result is the same as drawing them one by one.
+ * Only images are recorded: other drawing must not happen between beginning and ending the list.
+ */
+
+typedef enum {
+    DRAW_LIST_IMAGE,
+    DRAW_LIST_ENEMY,
+    DRAW_LIST_MASKED,
+    DRAW_LIST_BLEND,
+    DRAW_LIST_BLEND_ALPHA,
+    DRAW_LIST_LETTER,
+    DRAW_LIST_ISOMETRIC_FOOTPRINT,
+    DRAW_LIST_ISOMETRIC_FOOTPRINT_FROM_DRAW_TILE,
+    DRAW_LIST_ISOMETRIC_TOP,
+    DRAW_LIST_ISOMETRIC_TOP_FROM_DRAW_TILE,
+    DRAW_LIST_SCALED
+} draw_list_type;
+
+/**
+ * Starts recording image draws. Does nothing when there is only one thread to draw on.
+ */
+void draw_list_begin(void);
+
+/**
+ * Stops recording and draws the recorded images within the current clip rectangle
+ */
+void draw_list_end(void);
+
+/**
+ * Records an image draw
+ * @param type Image draw function
+ * @param image_id Image to draw
+ * @param x X position
+ * @param y Y position
+ * @param color Color or color mask passed to the draw function
+ * @return 1 if the draw was recorded, 0 if the caller should draw the image itself
+ */
+int draw_list_add(draw_list_type type, int image_id, int x, int y, color_t color);
+
+/**
+ * Records a letter draw
+ * @return 1 if the draw was recorded, 0 if the caller should draw the letter itself
+ */
+int draw_list_add_letter(font_t font, int letter_id, int x, int y, color_t color);
+
+/**
+ * Records a scaled image draw
+ * @return 1 if the draw was recorded, 0 if the caller should draw the image itself
+ */
+int draw_list_add_scaled(int image_id, int x, int y, double scale);
+
+#endif // GRAPHICS_DRAW_LIST_H
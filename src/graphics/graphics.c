@@ -2,6 +2,8 @@
 
 #include "city/view.h"
 #include "core/config.h"
+#include "core/thread_pool.h"
+#include "graphics/blend.h"
 #include "graphics/color.h"
 #include "graphics/menu.h"
 #include "game/system.h"
@@ -16,7 +18,8 @@ static struct {
     int height;
 } canvas[MAX_CANVAS];
 
-static struct {
+// Clipping is per thread, so that the city can be drawn in bands on several threads
+static THREAD_LOCAL struct {
     int x_start;
     int x_end;
     int y_start;
@@ -38,7 +41,7 @@ static struct {
     canvas_type type;
 } original_canvas;
 
-static clip_info clip;
+static THREAD_LOCAL clip_info clip;
 static canvas_type active_canvas;
 
 void graphics_init_canvas(int width, int height)
@@ -162,6 +165,14 @@ void graphics_set_clip_rectangle(int x, int y, int width, int height)
     }
 }
 
+void graphics_get_clip_rectangle(int *x, int *y, int *width, int *height)
+{
+    *x = clip_rectangle.x_start;
+    *y = clip_rectangle.y_start;
+    *width = clip_rectangle.x_end - clip_rectangle.x_start;
+    *height = clip_rectangle.y_end - clip_rectangle.y_start;
+}
+
 void graphics_reset_clip_rectangle(void)
 {
     clip_rectangle.x_start = 0;
@@ -366,14 +377,6 @@ void graphics_shade_rect(int x, int y, int width, int height, int darkness)
         return;
     }
     for (int yy = y + cur_clip->clipped_pixels_top; yy < y + height - cur_clip->clipped_pixels_bottom; yy++) {
-        for (int xx = x + cur_clip->clipped_pixels_left; xx < x + width - cur_clip->clipped_pixels_right; xx++) {
-            color_t *pixel = graphics_get_pixel(xx, yy);
-            int r = (*pixel & 0xff0000) >> 16;
-            int g = (*pixel & 0xff00) >> 8;
-            int b = (*pixel & 0xff);
-            int grey = (r + g + b) / 3 >> darkness;
-            color_t new_pixel = (color_t) (ALPHA_OPAQUE | grey << 16 | grey << 8 | grey);
-            *pixel = new_pixel;
-        }
+        blend_shade(graphics_get_pixel(x + cur_clip->clipped_pixels_left, yy), cur_clip->visible_pixels_x, darkness);
     }
 }
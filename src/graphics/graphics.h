@@ -44,6 +44,7 @@ void graphics_in_dialog_with_size(int width, int height);
 void graphics_reset_dialog(void);
 
 void graphics_set_clip_rectangle(int x, int y, int width, int height);
+void graphics_get_clip_rectangle(int *x, int *y, int *width, int *height);
 void graphics_reset_clip_rectangle(void);
 const clip_info *graphics_get_clip_info(int x, int y, int width, int height);
 
@@ -1,6 +1,8 @@
 #include "image.h"
 
 #include "core/log.h"
+#include "graphics/blend.h"
+#include "graphics/draw_list.h"
 #include "graphics/graphics.h"
 #include "graphics/screen.h"
 
@@ -171,16 +173,9 @@ static void draw_extra_asset_top(int image_id, int x_offset, int y_offset, color
                         data++;
                     }
                 }
-            } else {
-                for (int x = x_start; x < x_max; x++, dst++) {
-                    color_t alpha = *data & COLOR_CHANNEL_ALPHA;
-                    if (alpha == ALPHA_OPAQUE) {
-                        *dst = *data;
-                    } else if (alpha != ALPHA_TRANSPARENT) {
-                        *dst = COLOR_BLEND_ALPHA_TO_OPAQUE(*data, *dst, alpha >> COLOR_BITSHIFT_ALPHA);
-                    }
-                    data++;
-                }
+            } else if (x_max > x_start) {
+                blend_src_alpha(dst, data, x_max - x_start);
+                data += x_max - x_start;
             }
             if (half_image_only) {
                 data += clip->clipped_pixels_right;
@@ -221,16 +216,9 @@ static void draw_extra_asset_top(int image_id, int x_offset, int y_offset, color
                     data++;
                 }
             }
-        } else {
-            for (int x = x_start; x < x_max; x++, dst++) {
-                color_t alpha = *data & COLOR_CHANNEL_ALPHA;
-                if (alpha == ALPHA_OPAQUE) {
-                    *dst = *data;
-                } else if (alpha != ALPHA_TRANSPARENT) {
-                    *dst = COLOR_BLEND_ALPHA_TO_OPAQUE(*data, *dst, alpha >> COLOR_BITSHIFT_ALPHA);
-                }
-                data++;
-            }
+        } else if (x_max > x_start) {
+            blend_src_alpha(dst, data, x_max - x_start);
+            data += x_max - x_start;
         }
         if (x_start > x_max) {
             data -= x_start - x_max;
@@ -261,15 +249,8 @@ static void draw_asset_image(const image *img, const color_t *data, int x_offset
                 data++;
             }
         } else {
-            for (int x = clip->clipped_pixels_left; x < x_max; x++, dst++) {
-                color_t alpha = *data & COLOR_CHANNEL_ALPHA;
-                if (alpha == ALPHA_OPAQUE) {
-                    *dst = *data;
-                } else if (alpha != ALPHA_TRANSPARENT) {
-                    *dst = COLOR_BLEND_ALPHA_TO_OPAQUE(*data, *dst, alpha >> COLOR_BITSHIFT_ALPHA);
-                }
-                data++;
-            }
+            blend_src_alpha(dst, data, x_max - clip->clipped_pixels_left);
+            data += x_max - clip->clipped_pixels_left;
         }
         data += clip->clipped_pixels_right;
     }
@@ -365,9 +346,15 @@ static void draw_compressed(const image *img, const color_t *data, int x_offset,
     }
     int unclipped = clip->clip_x == CLIP_NONE;
 
-    for (int y = 0; y < height - clip->clipped_pixels_bottom; y++) {
+    const int *row_offsets = img->draw.row_offsets;
+    const color_t *rows = data;
+    int x_end = row_offsets ? img->width - clip->clipped_pixels_right : img->width;
+    for (int y = row_offsets ? clip->clipped_pixels_top : 0; y < height - clip->clipped_pixels_bottom; y++) {
+        if (row_offsets) {
+            data = &rows[row_offsets[y]];
+        }
         int x = 0;
-        while (x < img->width) {
+        while (x < x_end) {
             color_t b = *data;
             data++;
             if (b == 255) {
@@ -385,6 +372,8 @@ static void draw_compressed(const image *img, const color_t *data, int x_offset,
                 if (unclipped) {
                     x += b;
                     memcpy(dst, pixels, b * sizeof(color_t));
+                } else if (x + (int) b <= clip->clipped_pixels_left) {
+                    x += b;
                 } else {
                     while (b) {
                         if (x >= clip->clipped_pixels_left && x < img->width - clip->clipped_pixels_right) {
@@ -410,9 +399,15 @@ static void draw_compressed_set(
     }
     int unclipped = clip->clip_x == CLIP_NONE;
 
-    for (int y = 0; y < height - clip->clipped_pixels_bottom; y++) {
+    const int *row_offsets = img->draw.row_offsets;
+    const color_t *rows = data;
+    int x_end = row_offsets ? img->width - clip->clipped_pixels_right : img->width;
+    for (int y = row_offsets ? clip->clipped_pixels_top : 0; y < height - clip->clipped_pixels_bottom; y++) {
+        if (row_offsets) {
+            data = &rows[row_offsets[y]];
+        }
         int x = 0;
-        while (x < img->width) {
+        while (x < x_end) {
             color_t b = *data;
             data++;
             if (b == 255) {
@@ -432,6 +427,8 @@ static void draw_compressed_set(
                         dst++;
                         b--;
                     }
+                } else if (x + (int) b <= clip->clipped_pixels_left) {
+                    x += b;
                 } else {
                     while (b) {
                         if (x >= clip->clipped_pixels_left && x < img->width - clip->clipped_pixels_right) {
@@ -466,9 +463,15 @@ static void draw_compressed_masked(
 
     int unclipped = clip->clip_x == CLIP_NONE;
 
-    for (int y = 0; y < height - clip->clipped_pixels_bottom; y++) {
+    const int *row_offsets = img->draw.row_offsets;
+    const color_t *rows = data;
+    int x_end = row_offsets ? img->width - clip->clipped_pixels_right : img->width;
+    for (int y = row_offsets ? clip->clipped_pixels_top : 0; y < height - clip->clipped_pixels_bottom; y++) {
+        if (row_offsets) {
+            data = &rows[row_offsets[y]];
+        }
         int x = 0;
-        while (x < img->width) {
+        while (x < x_end) {
             color_t b = *data;
             data++;
             if (b == 255) {
@@ -486,12 +489,9 @@ static void draw_compressed_masked(
                 if (alpha_mask == ALPHA_OPAQUE) {
                     if (unclipped) {
                         x += b;
-                        while (b) {
-                            *dst = *pixels & color;
-                            dst++;
-                            pixels++;
-                            b--;
-                        }
+                        blend_mask(dst, pixels, b, color);
+                    } else if (x + (int) b <= clip->clipped_pixels_left) {
+                        x += b;
                     } else {
                         while (b) {
                             if (x >= clip->clipped_pixels_left && x < img->width - clip->clipped_pixels_right) {
@@ -506,12 +506,9 @@ static void draw_compressed_masked(
                 } else {
                     if (unclipped) {
                         x += b;
-                        while (b) {
-                            *dst = COLOR_BLEND_ALPHA_TO_OPAQUE(*pixels & color, *dst, alpha_mask >> COLOR_BITSHIFT_ALPHA);
-                            dst++;
-                            pixels++;
-                            b--;
-                        }
+                        blend_mask_alpha(dst, pixels, b, color, alpha_mask >> COLOR_BITSHIFT_ALPHA);
+                    } else if (x + (int) b <= clip->clipped_pixels_left) {
+                        x += b;
                     } else {
                         while (b) {
                             if (x >= clip->clipped_pixels_left && x < img->width - clip->clipped_pixels_right) {
@@ -538,9 +535,15 @@ static void draw_compressed_blend(
     }
     int unclipped = clip->clip_x == CLIP_NONE;
 
-    for (int y = 0; y < height - clip->clipped_pixels_bottom; y++) {
+    const int *row_offsets = img->draw.row_offsets;
+    const color_t *rows = data;
+    int x_end = row_offsets ? img->width - clip->clipped_pixels_right : img->width;
+    for (int y = row_offsets ? clip->clipped_pixels_top : 0; y < height - clip->clipped_pixels_bottom; y++) {
+        if (row_offsets) {
+            data = &rows[row_offsets[y]];
+        }
         int x = 0;
-        while (x < img->width) {
+        while (x < x_end) {
             color_t b = *data;
             data++;
             if (b == 255) {
@@ -555,11 +558,9 @@ static void draw_compressed_blend(
                 color_t *dst = graphics_get_pixel(x_offset + x, y_offset + y);
                 if (unclipped) {
                     x += b;
-                    while (b) {
-                        *dst &= color;
-                        dst++;
-                        b--;
-                    }
+                    blend_and(dst, b, color);
+                } else if (x + (int) b <= clip->clipped_pixels_left) {
+                    x += b;
                 } else {
                     while (b) {
                         if (x >= clip->clipped_pixels_left && x < img->width - clip->clipped_pixels_right) {
@@ -595,10 +596,16 @@ static void draw_compressed_blend_alpha(
     color_t src_g = (color & COLOR_CHANNEL_GREEN) * alpha;
     int unclipped = clip->clip_x == CLIP_NONE;
 
-    for (int y = 0; y < height - clip->clipped_pixels_bottom; y++) {
+    const int *row_offsets = img->draw.row_offsets;
+    const color_t *rows = data;
+    int x_end = row_offsets ? img->width - clip->clipped_pixels_right : img->width;
+    for (int y = row_offsets ? clip->clipped_pixels_top : 0; y < height - clip->clipped_pixels_bottom; y++) {
+        if (row_offsets) {
+            data = &rows[row_offsets[y]];
+        }
         int x = 0;
         color_t *dst = graphics_get_pixel(x_offset, y_offset + y);
-        while (x < img->width) {
+        while (x < x_end) {
             color_t b = *data;
             data++;
             if (b == 255) {
@@ -614,13 +621,11 @@ static void draw_compressed_blend_alpha(
                 data += b;
                 if (unclipped) {
                     x += b;
-                    while (b) {
-                        color_t d = *dst;
-                        *dst = (((src_rb + (d & COLOR_CHANNEL_RB) * alpha_dst) & (COLOR_CHANNEL_RB << 8)) |
-                            ((src_g + (d & COLOR_CHANNEL_GREEN) * alpha_dst) & (COLOR_CHANNEL_GREEN << 8))) >> 8;
-                        b--;
-                        dst++;
-                    }
+                    blend_color_alpha(dst, b, color);
+                    dst += b;
+                } else if (x + (int) b <= clip->clipped_pixels_left) {
+                    x += b;
+                    dst += b;
                 } else {
                     while (b) {
                         if (x >= clip->clipped_pixels_left && x < img->width - clip->clipped_pixels_right) {
@@ -732,15 +737,11 @@ static void draw_footprint_tile(const color_t *data, int x_offset, int y_offset,
             src += x_max + x_pixel_advance;
         } else {
             if (alpha_mask == ALPHA_OPAQUE) {
-                for (int x = 0; x < x_max; x++, buffer++, src++) {
-                    *buffer = *src & color_mask;
-                }
+                blend_mask(buffer, src, x_max, color_mask);
             } else {
-                for (int x = 0; x < x_max; x++, buffer++, src++) {
-                    *buffer = COLOR_BLEND_ALPHA_TO_OPAQUE(*src & color_mask, *buffer, alpha_mask >> COLOR_BITSHIFT_ALPHA);
-                }
+                blend_mask_alpha(buffer, src, x_max, color_mask, alpha_mask >> COLOR_BITSHIFT_ALPHA);
             }
-            src += x_pixel_advance;
+            src += x_max + x_pixel_advance;
         }
     }
 }
@@ -926,6 +927,9 @@ static void draw_footprint_size7(int image_id, int x, int y, color_t color_mask)
 
 void image_draw(int image_id, int x, int y)
 {
+    if (draw_list_add(DRAW_LIST_IMAGE, image_id, x, y, 0)) {
+        return;
+    }
     const image *img = image_get(image_id);
     const color_t *data = image_data(image_id);
     if (!data) {
@@ -941,6 +945,9 @@ void image_draw(int image_id, int x, int y)
 
 void image_draw_enemy(int image_id, int x, int y)
 {
+    if (draw_list_add(DRAW_LIST_ENEMY, image_id, x, y, 0)) {
+        return;
+    }
     if (image_id <= 0 || image_id >= 801) {
         return;
     }
@@ -953,6 +960,9 @@ void image_draw_enemy(int image_id, int x, int y)
 
 void image_draw_masked(int image_id, int x, int y, color_t color_mask)
 {
+    if (draw_list_add(DRAW_LIST_MASKED, image_id, x, y, color_mask)) {
+        return;
+    }
     const image *img = image_get(image_id);
     const color_t *data = image_data(image_id);
     if (!data) {
@@ -978,6 +988,9 @@ void image_draw_masked(int image_id, int x, int y, color_t color_mask)
 
 void image_draw_blend(int image_id, int x, int y, color_t color)
 {
+    if (draw_list_add(DRAW_LIST_BLEND, image_id, x, y, color)) {
+        return;
+    }
     const image *img = image_get(image_id);
     const color_t *data = image_data(image_id);
     if (!data) {
@@ -997,6 +1010,9 @@ void image_draw_blend(int image_id, int x, int y, color_t color)
 
 void image_draw_blend_alpha(int image_id, int x, int y, color_t color)
 {
+    if (draw_list_add(DRAW_LIST_BLEND_ALPHA, image_id, x, y, color)) {
+        return;
+    }
     const image *img = image_get(image_id);
     const color_t *data = image_data(image_id);
     if (!data) {
@@ -1042,6 +1058,9 @@ static void draw_multibyte_letter(font_t font, const image *img, const color_t *
 
 void image_draw_letter(font_t font, int letter_id, int x, int y, color_t color)
 {
+    if (draw_list_add_letter(font, letter_id, x, y, color)) {
+        return;
+    }
     const image *img = image_letter(letter_id);
     const color_t *data = image_data_letter(letter_id);
     if (!data) {
@@ -1114,6 +1133,9 @@ void image_draw_fullscreen_background(int image_id)
 
 void image_draw_isometric_footprint(int image_id, int x, int y, color_t color_mask)
 {
+    if (draw_list_add(DRAW_LIST_ISOMETRIC_FOOTPRINT, image_id, x, y, color_mask)) {
+        return;
+    }
     const image *img = image_get(image_id);
     if (img->draw.type != IMAGE_TYPE_ISOMETRIC) {
         if (img->draw.type == IMAGE_TYPE_EXTRA_ASSET) {
@@ -1145,6 +1167,9 @@ void image_draw_isometric_footprint(int image_id, int x, int y, color_t color_ma
 
 void image_draw_isometric_footprint_from_draw_tile(int image_id, int x, int y, color_t color_mask)
 {
+    if (draw_list_add(DRAW_LIST_ISOMETRIC_FOOTPRINT_FROM_DRAW_TILE, image_id, x, y, color_mask)) {
+        return;
+    }
     const image *img = image_get(image_id);
     if (img->draw.type != IMAGE_TYPE_ISOMETRIC) {
         if (img->draw.type == IMAGE_TYPE_EXTRA_ASSET) {
@@ -1177,6 +1202,9 @@ void image_draw_isometric_footprint_from_draw_tile(int image_id, int x, int y, c
 
 void image_draw_isometric_top(int image_id, int x, int y, color_t color_mask)
 {
+    if (draw_list_add(DRAW_LIST_ISOMETRIC_TOP, image_id, x, y, color_mask)) {
+        return;
+    }
     const image *img = image_get(image_id);
     if (img->draw.type != IMAGE_TYPE_ISOMETRIC) {
         if (img->draw.type == IMAGE_TYPE_EXTRA_ASSET) {
@@ -1225,6 +1253,9 @@ void image_draw_isometric_top(int image_id, int x, int y, color_t color_mask)
 
 void image_draw_isometric_top_from_draw_tile(int image_id, int x, int y, color_t color_mask)
 {
+    if (draw_list_add(DRAW_LIST_ISOMETRIC_TOP_FROM_DRAW_TILE, image_id, x, y, color_mask)) {
+        return;
+    }
     const image *img = image_get(image_id);
     if (img->draw.type != IMAGE_TYPE_ISOMETRIC) {
         if (img->draw.type == IMAGE_TYPE_EXTRA_ASSET) {
@@ -1269,6 +1300,9 @@ void image_draw_isometric_top_from_draw_tile(int image_id, int x, int y, color_t
 
 void image_draw_scaled(int image_id, int x_offset, int y_offset, double scale_factor)
 {
+    if (draw_list_add_scaled(image_id, x_offset, y_offset, scale_factor)) {
+        return;
+    }
     const image *img = image_get(image_id);
     const color_t *data = image_data(image_id);
 
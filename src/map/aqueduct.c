@@ -11,6 +11,15 @@
 static grid_u8 aqueduct;
 static grid_u8 aqueduct_backup;
 
+static struct {
+    int version;
+} data;
+
+int map_aqueduct_version(void)
+{
+    return data.version;
+}
+
 int map_aqueduct_at(int grid_offset)
 {
     return aqueduct.items[grid_offset];
@@ -18,11 +27,13 @@ int map_aqueduct_at(int grid_offset)
 
 void map_aqueduct_set(int grid_offset, int value)
 {
+    data.version++;
     aqueduct.items[grid_offset] = value;
 }
 
 void map_aqueduct_remove(int grid_offset)
 {
+    data.version++;
     aqueduct.items[grid_offset] = 0;
     if (aqueduct.items[grid_offset + map_grid_delta(0, -1)] == 5) {
         aqueduct.items[grid_offset + map_grid_delta(0, -1)] = 1;
@@ -40,6 +51,7 @@ void map_aqueduct_remove(int grid_offset)
 
 void map_aqueduct_clear(void)
 {
+    data.version++;
     map_grid_clear_u8(aqueduct.items);
 }
 
@@ -50,6 +62,7 @@ void map_aqueduct_backup(void)
 
 void map_aqueduct_restore(void)
 {
+    data.version++;
     map_grid_copy_u8(aqueduct_backup.items, aqueduct.items);
 }
 
@@ -61,6 +74,7 @@ void map_aqueduct_save_state(buffer *buf, buffer *backup)
 
 void map_aqueduct_load_state(buffer *buf, buffer *backup)
 {
+    data.version++;
     map_grid_load_state_u8(aqueduct.items, buf);
     map_grid_load_state_u8(aqueduct_backup.items, backup);
 }
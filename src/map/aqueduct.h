@@ -5,6 +5,12 @@
 
 int map_aqueduct_at(int grid_offset);
 
+/**
+ * Gets the aqueduct grid version, which changes every time the grid is written to
+ * @return Aqueduct grid version
+ */
+int map_aqueduct_version(void);
+
 void map_aqueduct_set(int grid_offset, int value);
 
 /**
@@ -5,10 +5,13 @@
 #include "map/grid.h"
 
 static grid_u16 buildings_grid;
+static grid_u16 houses_grid;
 static grid_u8 damage_grid;
 static grid_u8 rubble_type_grid;
 static grid_u8 highlight_grid;
 
+static int houses_need_rebuild;
+
 int map_building_at(int grid_offset)
 {
     return map_grid_is_valid_offset(grid_offset) ? buildings_grid.items[grid_offset] : 0;
@@ -17,6 +20,33 @@ int map_building_at(int grid_offset)
 void map_building_set(int grid_offset, int building_id)
 {
     buildings_grid.items[grid_offset] = building_id;
+    houses_grid.items[grid_offset] = building_id && building_get(building_id)->house_size ? building_id : 0;
+}
+
+static void rebuild_houses(void)
+{
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        int building_id = buildings_grid.items[i];
+        houses_grid.items[i] = building_id && building_get(building_id)->house_size ? building_id : 0;
+    }
+    houses_need_rebuild = 0;
+}
+
+int map_building_houses_in_area(int x_min, int y_min, int x_max, int y_max, int *house_ids, int max_ids)
+{
+    if (houses_need_rebuild) {
+        rebuild_houses();
+    }
+    int num_ids = 0;
+    for (int y = y_min; y <= y_max; y++) {
+        const uint16_t *row = &houses_grid.items[map_grid_offset(x_min, y)];
+        for (int x = 0; x <= x_max - x_min; x++) {
+            if (row[x] && num_ids < max_ids) {
+                house_ids[num_ids++] = row[x];
+            }
+        }
+    }
+    return num_ids;
 }
 
 void map_building_damage_clear(int grid_offset)
@@ -62,6 +92,8 @@ void map_set_rubble_building_type(int grid_offset, building_type type)
 void map_building_clear(void)
 {
     map_grid_clear_u16(buildings_grid.items);
+    map_grid_clear_u16(houses_grid.items);
+    houses_need_rebuild = 0;
     map_grid_clear_u8(damage_grid.items);
     map_grid_clear_u8(rubble_type_grid.items);
 }
@@ -81,6 +113,8 @@ void map_building_load_state(buffer *buildings, buffer *damage)
 {
     map_grid_load_state_u16(buildings_grid.items, buildings);
     map_grid_load_state_u8(damage_grid.items, damage);
+    // The buildings may not be loaded yet
+    houses_need_rebuild = 1;
 }
 
 int map_building_is_reservoir(int x, int y)
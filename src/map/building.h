@@ -13,6 +13,20 @@ int map_building_at(int grid_offset);
 
 void map_building_set(int grid_offset, int building_id);
 
+/**
+ * Lists the houses on the tiles of an area, row by row.
+ * A house is listed once for each of its tiles in the area.
+ * Houses that were destroyed since their tiles were set may still be listed: check the house size.
+ * @param x_min Left of the area, must be on the map
+ * @param y_min Top of the area, must be on the map
+ * @param x_max Right of the area, must be on the map
+ * @param y_max Bottom of the area, must be on the map
+ * @param house_ids Array to fill with the building IDs of the houses
+ * @param max_ids Size of the house_ids array
+ * @return Number of house IDs written
+ */
+int map_building_houses_in_area(int x_min, int y_min, int x_max, int y_max, int *house_ids, int max_ids);
+
 /**
  * Increases building damage by 1
  * @param grid_offset Map offset
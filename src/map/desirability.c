@@ -10,14 +10,83 @@
 #include "map/ring.h"
 #include "map/terrain.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DESIRABILITY 100
+#define SOURCES_SIZE_STEP 1024
+
+typedef enum {
+    SOURCE_BUILDING = 0,
+    SOURCE_TERRAIN = 1
+} source_kind;
+
+typedef enum {
+    STAMP_GRID = 0,
+    STAMP_ADD = 1,
+    STAMP_REMOVE = 2
+} stamp_mode;
+
+typedef struct {
+    source_kind kind;
+    int id; // building id or grid offset
+    int x;
+    int y;
+    int size;
+    int desirability;
+    int step;
+    int step_size;
+    int range;
+} desirability_source;
+
+typedef struct {
+    desirability_source *items;
+    int size;
+    int capacity;
+} source_list;
+
+typedef void (*source_callback)(source_kind kind, int id, int x, int y, int size,
+    int desirability, int step, int step_size, int range);
+
 static grid_i8 desirability_grid;
 
+// The grid can be patched when a tile is given the same contributions in the same order as during the last update,
+// or when the positive and negative contributions to a tile can never be cut off at the maximum in any order
+static struct {
+    int is_valid;
+    int out_of_memory;
+    source_list sources[2];
+    int current_sources;
+    int positive[GRID_SIZE * GRID_SIZE];
+    int negative[GRID_SIZE * GRID_SIZE];
+    uint8_t touched[GRID_SIZE * GRID_SIZE];
+    int touched_offsets[GRID_SIZE * GRID_SIZE];
+    int num_touched;
+} incremental;
+
 void map_desirability_clear(void)
 {
     map_grid_clear_i8(desirability_grid.items);
+    incremental.is_valid = 0;
 }
 
-static void add_desirability_at_distance(int x, int y, int size, int distance, int desirability)
+static void stamp_tile(int grid_offset, int desirability, stamp_mode mode)
+{
+    int *sum = desirability > 0 ? incremental.positive : incremental.negative;
+    if (mode == STAMP_GRID) {
+        desirability_grid.items[grid_offset] = calc_bound(desirability_grid.items[grid_offset] + desirability,
+            -MAX_DESIRABILITY, MAX_DESIRABILITY);
+        sum[grid_offset] += desirability;
+        return;
+    }
+    sum[grid_offset] += mode == STAMP_REMOVE ? -desirability : desirability;
+    if (!incremental.touched[grid_offset]) {
+        incremental.touched[grid_offset] = 1;
+        incremental.touched_offsets[incremental.num_touched++] = grid_offset;
+    }
+}
+
+static void add_desirability_at_distance(int x, int y, int size, int distance, int desirability, stamp_mode mode)
 {
     int partially_outside_map = 0;
     if (x - distance < -1 || x + distance + size - 1 > map_data.width) {
@@ -34,20 +103,19 @@ static void add_desirability_at_distance(int x, int y, int size, int distance, i
         for (int i = start; i < end; i++) {
             const ring_tile *tile = map_ring_tile(i);
             if (map_ring_is_inside_map(x + tile->x, y + tile->y)) {
-                desirability_grid.items[base_offset + tile->grid_offset] =
-                    calc_bound(desirability_grid.items[base_offset + tile->grid_offset] + desirability, -100, 100);
+                stamp_tile(base_offset + tile->grid_offset, desirability, mode);
             }
         }
     } else {
         for (int i = start; i < end; i++) {
             const ring_tile *tile = map_ring_tile(i);
-            desirability_grid.items[base_offset + tile->grid_offset] =
-                calc_bound(desirability_grid.items[base_offset + tile->grid_offset] + desirability, -100, 100);
+            stamp_tile(base_offset + tile->grid_offset, desirability, mode);
         }
     }
 }
 
-static void add_to_terrain(int x, int y, int size, int desirability, int step, int step_size, int range)
+static void add_to_terrain(int x, int y, int size, int desirability, int step, int step_size, int range,
+    stamp_mode mode)
 {
     if (size > 0) {
         if (range > 6) {
@@ -56,7 +124,7 @@ static void add_to_terrain(int x, int y, int size, int desirability, int step, i
         int tiles_within_step = 0;
         int distance = 1;
         while (range > 0) {
-            add_desirability_at_distance(x, y, size, distance, desirability);
+            add_desirability_at_distance(x, y, size, distance, desirability, mode);
             distance++;
             range--;
             tiles_within_step++;
@@ -68,7 +136,48 @@ static void add_to_terrain(int x, int y, int size, int desirability, int step, i
     }
 }
 
-static void update_buildings(void)
+static void stamp_source(const desirability_source *source, stamp_mode mode)
+{
+    add_to_terrain(source->x, source->y, source->size, source->desirability,
+        source->step, source->step_size, source->range, mode);
+}
+
+static void stamp_on_grid(source_kind kind, int id, int x, int y, int size,
+    int desirability, int step, int step_size, int range)
+{
+    add_to_terrain(x, y, size, desirability, step, step_size, range, STAMP_GRID);
+}
+
+static void add_source(source_kind kind, int id, int x, int y, int size,
+    int desirability, int step, int step_size, int range)
+{
+    source_list *list = &incremental.sources[incremental.current_sources ^ 1];
+    if (incremental.out_of_memory) {
+        return;
+    }
+    if (list->size >= list->capacity) {
+        int capacity = list->capacity + SOURCES_SIZE_STEP;
+        desirability_source *items = realloc(list->items, capacity * sizeof(desirability_source));
+        if (!items) {
+            incremental.out_of_memory = 1;
+            return;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    desirability_source *source = &list->items[list->size++];
+    source->kind = kind;
+    source->id = id;
+    source->x = x;
+    source->y = y;
+    source->size = size;
+    source->desirability = desirability;
+    source->step = step;
+    source->step_size = step_size;
+    source->range = range;
+}
+
+static void update_buildings(source_callback add)
 {
     int value;
     int value_bonus;
@@ -77,7 +186,10 @@ static void update_buildings(void)
     int range;
     int venus_module2 = building_monument_gt_module_is_active(VENUS_MODULE_2_DESIRABILITY_ENTERTAINMENT);
     int venus_gt = building_monument_working(BUILDING_GRAND_TEMPLE_VENUS);
-    for (int i = 1; i < building_count(); i++) {
+    int num_ids;
+    const int *ids = building_index_ids(BUILDING_INDEX_ALL, &num_ids);
+    for (int n = 0; n < num_ids; n++) {
+        int i = ids ? ids[n] : n;
         building *b = building_get(i);
         if (b->state == BUILDING_STATE_IN_USE) {
 
@@ -112,17 +224,12 @@ static void update_buildings(void)
                 range += 1;
             }
 
-            add_to_terrain(
-                b->x, b->y, b->size,
-                value,
-                step,
-                step_size,
-                range);
+            add(SOURCE_BUILDING, i, b->x, b->y, b->size, value, step, step_size, range);
         }
     }
 }
 
-static void update_terrain(void)
+static void update_terrain(source_callback add)
 {
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
@@ -141,30 +248,113 @@ static void update_terrain(void)
                     continue;
                 }
                 const model_building *model = model_get_building(type);
-                add_to_terrain(x, y, 1,
+                add(SOURCE_TERRAIN, grid_offset, x, y, 1,
                     model->desirability_value,
                     model->desirability_step,
                     model->desirability_step_size,
                     model->desirability_range);
             } else if (terrain & TERRAIN_GARDEN) {
                 const model_building *model = model_get_building(BUILDING_GARDENS);
-                add_to_terrain(x, y, 1,
+                add(SOURCE_TERRAIN, grid_offset, x, y, 1,
                     model->desirability_value,
                     model->desirability_step,
                     model->desirability_step_size,
                     model->desirability_range);
             } else if (terrain & TERRAIN_RUBBLE) {
-                add_to_terrain(x, y, 1, -2, 1, 1, 2);
+                add(SOURCE_TERRAIN, grid_offset, x, y, 1, -2, 1, 1, 2);
             }
         }
     }
 }
 
+static int same_key(const desirability_source *a, const desirability_source *b)
+{
+    return a->kind == b->kind && a->id == b->id;
+}
+
+static int key_is_before(const desirability_source *a, const desirability_source *b)
+{
+    return a->kind < b->kind || (a->kind == b->kind && a->id < b->id);
+}
+
+static int same_contribution(const desirability_source *a, const desirability_source *b)
+{
+    return a->x == b->x && a->y == b->y && a->size == b->size && a->desirability == b->desirability &&
+        a->step == b->step && a->step_size == b->step_size && a->range == b->range;
+}
+
+static void rebuild(const source_list *sources)
+{
+    map_grid_clear_i8(desirability_grid.items);
+    memset(incremental.positive, 0, sizeof(incremental.positive));
+    memset(incremental.negative, 0, sizeof(incremental.negative));
+    for (int i = 0; i < sources->size; i++) {
+        stamp_source(&sources->items[i], STAMP_GRID);
+    }
+}
+
+static int apply_changed_sources(const source_list *previous, const source_list *current)
+{
+    incremental.num_touched = 0;
+    int p = 0;
+    int c = 0;
+    while (p < previous->size || c < current->size) {
+        const desirability_source *old_source = p < previous->size ? &previous->items[p] : 0;
+        const desirability_source *new_source = c < current->size ? &current->items[c] : 0;
+        if (!new_source || (old_source && key_is_before(old_source, new_source))) {
+            stamp_source(old_source, STAMP_REMOVE);
+            p++;
+        } else if (!old_source || !same_key(old_source, new_source)) {
+            stamp_source(new_source, STAMP_ADD);
+            c++;
+        } else {
+            if (!same_contribution(old_source, new_source)) {
+                stamp_source(old_source, STAMP_REMOVE);
+                stamp_source(new_source, STAMP_ADD);
+            }
+            p++;
+            c++;
+        }
+    }
+    int can_patch = 1;
+    for (int i = 0; i < incremental.num_touched; i++) {
+        int grid_offset = incremental.touched_offsets[i];
+        incremental.touched[grid_offset] = 0;
+        if (incremental.positive[grid_offset] > MAX_DESIRABILITY ||
+            incremental.negative[grid_offset] < -MAX_DESIRABILITY) {
+            can_patch = 0;
+        }
+    }
+    if (!can_patch) {
+        return 0;
+    }
+    for (int i = 0; i < incremental.num_touched; i++) {
+        int grid_offset = incremental.touched_offsets[i];
+        desirability_grid.items[grid_offset] = incremental.positive[grid_offset] + incremental.negative[grid_offset];
+    }
+    return 1;
+}
+
 void map_desirability_update(void)
 {
-    map_desirability_clear();
-    update_buildings();
-    update_terrain();
+    source_list *current = &incremental.sources[incremental.current_sources ^ 1];
+    current->size = 0;
+    incremental.out_of_memory = 0;
+    update_buildings(add_source);
+    update_terrain(add_source);
+    if (incremental.out_of_memory) {
+        incremental.is_valid = 0;
+        map_grid_clear_i8(desirability_grid.items);
+        update_buildings(stamp_on_grid);
+        update_terrain(stamp_on_grid);
+        return;
+    }
+    const source_list *previous = &incremental.sources[incremental.current_sources];
+    if (!incremental.is_valid || !apply_changed_sources(previous, current)) {
+        rebuild(current);
+    }
+    incremental.is_valid = 1;
+    incremental.current_sources ^= 1;
 }
 
 int map_desirability_get(int grid_offset)
@@ -197,4 +387,5 @@ void map_desirability_save_state(buffer *buf)
 void map_desirability_load_state(buffer *buf)
 {
     map_grid_load_state_i8(desirability_grid.items, buf);
+    incremental.is_valid = 0;
 }
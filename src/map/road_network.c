@@ -13,6 +13,13 @@
 static const int ADJACENT_OFFSETS[] = {-GRID_SIZE, 1, GRID_SIZE, -1};
 
 static grid_u8 network;
+static grid_u8 previous_network;
+
+static struct {
+    int needs_update;
+    int routing_version;
+    int version;
+} data;
 
 static struct {
     int items[MAX_QUEUE];
@@ -23,6 +30,13 @@ static struct {
 void map_road_network_clear(void)
 {
     map_grid_clear_u8(network.items);
+    data.needs_update = 1;
+    data.version++;
+}
+
+int map_road_network_version(void)
+{
+    return data.version;
 }
 
 int map_road_network_get(int grid_offset)
@@ -75,6 +89,14 @@ static int mark_road_network(int grid_offset, uint8_t network_id)
 
 void map_road_network_update(void)
 {
+    // The networks only follow the routing grids, so they stay the same until those are rebuilt
+    if (!data.needs_update && data.routing_version == map_routing_terrain_version()) {
+        return;
+    }
+    data.needs_update = 0;
+    data.routing_version = map_routing_terrain_version();
+    memcpy(previous_network.items, network.items, sizeof(network.items));
+
     city_map_clear_largest_road_networks();
     map_grid_clear_u8(network.items);
     int network_id = 1;
@@ -88,4 +110,7 @@ void map_road_network_update(void)
             }
         }
     }
+    if (memcmp(previous_network.items, network.items, sizeof(network.items)) != 0) {
+        data.version++;
+    }
 }
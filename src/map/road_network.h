@@ -5,6 +5,17 @@ void map_road_network_clear(void);
 
 int map_road_network_get(int grid_offset);
 
+/**
+ * Gets the road network version, which changes every time the network of a road tile changes.
+ * Buildings only take their new road network id in the daily road access check,
+ * so lookups keyed on building road network ids also need to follow that check.
+ * @return Road network version
+ */
+int map_road_network_version(void);
+
+/**
+ * Relabels the road networks, unless the routing grids have not been rebuilt since the last time
+ */
 void map_road_network_update(void);
 
 #endif // MAP_ROAD_NETWORK_H
@@ -1,12 +1,14 @@
 #include "routing.h"
 
 #include "building/building.h"
+#include "core/config.h"
 #include "core/time.h"
 #include "map/building.h"
 #include "map/figure.h"
 #include "map/grid.h"
 #include "map/road_aqueduct.h"
 #include "map/routing_data.h"
+#include "map/routing_terrain.h"
 #include "map/terrain.h"
 
 #include <stdlib.h>
@@ -17,6 +19,15 @@
 #define UNTIL_STOP 0
 #define UNTIL_CONTINUE 1
 
+#define CHUNK_SIZE 8
+#define CHUNKS_PER_ROW ((GRID_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE)
+#define MAX_CHUNKS (CHUNKS_PER_ROW * CHUNKS_PER_ROW)
+#define LONG_ROUTE_DISTANCE 48
+
+#define CHUNK_PASSABLE 1
+#define CHUNK_LINK_RIGHT 2
+#define CHUNK_LINK_DOWN 4
+
 typedef enum {
     DIRECTIONS_NO_DIAGONALS = 4,
     DIRECTIONS_DIAGONALS = 8
@@ -26,26 +37,40 @@ static const int ROUTE_OFFSETS[] = { -162, 1, 162, -1, -161, 163, 161, -163 };
 static const int ROUTE_OFFSETS_X[] = { 0, 1, 0, -1,  1, 1, -1, -1 };
 static const int ROUTE_OFFSETS_Y[] = { -1, 0, 1,  0, -1, 1,  1, -1 };
 
-static struct {
-    grid_i16 possible;
-    grid_i16 determined;
-    int dst_x;
-    int dst_y;
-} distance;
+struct routing_search {
+    struct {
+        grid_i16 possible;
+        grid_i16 determined;
+        int dst_x;
+        int dst_y;
+    } distance;
+    struct {
+        int head;
+        int tail;
+        int items[MAX_QUEUE];
+        grid_u16 positions; // index in the ordered queue for each enqueued tile
+    } queue;
+    grid_u8 water_drag;
+    struct {
+        int count;
+        int items[MAX_QUEUE];
+    } touched;
+    struct {
+        uint8_t corridor[MAX_CHUNKS];
+        int parent[MAX_CHUNKS];
+        int queue[MAX_CHUNKS];
+        int active;
+    } hierarchy;
+    routing_tick_stats tick;
+};
+
+static routing_search game_search;
 
 static struct {
     int total_routes_calculated;
     int enemy_routes_calculated;
 } stats;
 
-static struct {
-    int head;
-    int tail;
-    int items[MAX_QUEUE];
-} queue;
-
-static grid_u8 water_drag;
-
 static struct {
     grid_u8 status;
     time_millis last_check;
@@ -55,6 +80,20 @@ static struct {
     int through_building_id;
 } state;
 
+typedef enum {
+    CHUNK_GRAPH_CITIZEN_LAND = 0,
+    CHUNK_GRAPH_CITIZEN_ROAD_GARDEN = 1,
+    MAX_CHUNK_GRAPHS = 2
+} chunk_graph_type;
+
+typedef struct {
+    int terrain_version;
+    int is_valid;
+    uint8_t chunks[MAX_CHUNKS];
+} chunk_graph;
+
+static chunk_graph chunk_graphs[MAX_CHUNK_GRAPHS];
+
 static void reset_fighting_status(void)
 {
     time_millis current_time = time_get_millis();
@@ -64,29 +103,59 @@ static void reset_fighting_status(void)
     }
 }
 
-static void clear_data(void)
+static void clear_touched_tiles(routing_search *search)
 {
-    reset_fighting_status();
-    map_grid_clear_i16(distance.possible.items);
-    map_grid_clear_i16(distance.determined.items);
-    queue.head = 0;
-    queue.tail = 0;
+    if (search->touched.count > MAX_QUEUE / 4) {
+        // a full clear is faster when the last search covered a large part of the map
+        map_grid_clear_i16(search->distance.possible.items);
+        map_grid_clear_i16(search->distance.determined.items);
+        map_grid_clear_u8(search->water_drag.items);
+    } else {
+        for (int i = 0; i < search->touched.count; i++) {
+            int offset = search->touched.items[i];
+            search->distance.possible.items[offset] = 0;
+            search->distance.determined.items[offset] = 0;
+            search->water_drag.items[offset] = 0;
+        }
+    }
+    search->touched.count = 0;
 }
 
-static inline void enqueue(int next_offset, int dist)
+static void clear_data(routing_search *search)
 {
-    distance.determined.items[next_offset] = dist;
-    queue.items[queue.tail++] = next_offset;
-    if (queue.tail >= MAX_QUEUE) {
-        queue.tail = 0;
+    clear_touched_tiles(search);
+    search->queue.head = 0;
+    search->queue.tail = 0;
+}
+
+static inline void touch(routing_search *search, int offset)
+{
+    if (!search->distance.determined.items[offset] && !search->distance.possible.items[offset]) {
+        search->touched.items[search->touched.count++] = offset;
+    }
+}
+
+static inline void set_distance_blocked(routing_search *search, int offset)
+{
+    touch(search, offset);
+    search->distance.determined.items[offset] = -1;
+}
+
+static inline void enqueue(routing_search *search, int next_offset, int dist)
+{
+    touch(search, next_offset);
+    search->distance.determined.items[next_offset] = dist;
+    search->queue.items[search->queue.tail++] = next_offset;
+    if (search->queue.tail >= MAX_QUEUE) {
+        search->queue.tail = 0;
     }
 }
 
-static inline int queue_pop(void)
+static inline int queue_pop(routing_search *search)
 {
-    int result = queue.items[queue.head];
-    if (++queue.head >= MAX_QUEUE) {
-        queue.head = 0;
+    int result = search->queue.items[search->queue.head];
+    if (++search->queue.head >= MAX_QUEUE) {
+        search->queue.head = 0;
     }
     return result;
 }
@@ -96,109 +165,127 @@ static inline int ordered_queue_parent(int index)
     return (index - 1) / 2;
 }
 
-static inline void ordered_queue_swap(int first, int second)
+static inline void ordered_queue_set(routing_search *search, int index, int offset)
 {
-    int temp = queue.items[first];
-    queue.items[first] = queue.items[second];
-    queue.items[second] = temp;
+    search->queue.items[index] = offset;
+    search->queue.positions.items[offset] = index;
 }
 
-void ordered_queue_reorder(int start_index)
+static inline void ordered_queue_swap(routing_search *search, int first, int second)
+{
+    int temp = search->queue.items[first];
+    ordered_queue_set(search, first, search->queue.items[second]);
+    ordered_queue_set(search, second, temp);
+}
+
+void ordered_queue_reorder(routing_search *search, int start_index)
 {
     int left_child = 2 * start_index + 1;
-    if (left_child >= queue.tail) {
+    if (left_child >= search->queue.tail) {
         return;
     }
     int right_child = left_child + 1;
     int smallest = start_index;
-    int16_t *offset_smallest = &distance.possible.items[queue.items[smallest]];
-    if (distance.possible.items[queue.items[left_child]] < *offset_smallest) {
+    int16_t *offset_smallest = &search->distance.possible.items[search->queue.items[smallest]];
+    if (search->distance.possible.items[search->queue.items[left_child]] < *offset_smallest) {
         smallest = left_child;
-        offset_smallest = &distance.possible.items[queue.items[smallest]];
+        offset_smallest = &search->distance.possible.items[search->queue.items[smallest]];
     }
-    if (right_child < queue.tail &&
-        distance.possible.items[queue.items[right_child]] < *offset_smallest) {
+    if (right_child < search->queue.tail &&
+        search->distance.possible.items[search->queue.items[right_child]] < *offset_smallest) {
         smallest = right_child;
     }
     if (smallest != start_index) {
-        ordered_queue_swap(start_index, smallest);
-        ordered_queue_reorder(smallest);
+        ordered_queue_swap(search, start_index, smallest);
+        ordered_queue_reorder(search, smallest);
     }
 }
 
-static inline int ordered_queue_pop(void)
+static inline int ordered_queue_pop(routing_search *search)
 {
-    int min = queue.items[0];
-    queue.items[0] = queue.items[--queue.tail];
-    ordered_queue_reorder(0);
+    int min = search->queue.items[0];
+    ordered_queue_set(search, 0, search->queue.items[--search->queue.tail]);
+    ordered_queue_reorder(search, 0);
     return min;
 }
 
-static inline void ordered_queue_reduce_index(int index, int offset, int dist)
+static inline void ordered_queue_reduce_index(routing_search *search, int index, int offset, int dist)
 {
-    queue.items[index] = offset;
-    while (index && distance.possible.items[queue.items[ordered_queue_parent(index)]] > dist) {
-        ordered_queue_swap(index, ordered_queue_parent(index));
+    ordered_queue_set(search, index, offset);
+    while (index && search->distance.possible.items[search->queue.items[ordered_queue_parent(index)]] > dist) {
+        ordered_queue_swap(search, index, ordered_queue_parent(index));
         index = ordered_queue_parent(index);
     }
 }
 
-static void ordered_enqueue(int next_offset, int current_dist, int remaining_dist)
+static void ordered_enqueue(routing_search *search, int next_offset, int current_dist, int remaining_dist)
 {
     int possible_dist = remaining_dist + current_dist;
-    int index = queue.tail;
-    if (distance.possible.items[next_offset]) {
-        if (distance.possible.items[next_offset] <= possible_dist) {
+    int index = search->queue.tail;
+    if (search->distance.possible.items[next_offset]) {
+        if (search->distance.possible.items[next_offset] <= possible_dist) {
             return;
-        } else {
-            for (int i = 0; i < queue.tail; i++) {
-                if (queue.items[i] == next_offset) {
-                    index = i;
-                    break;
-                }
-            }
+        }
+        // the position grid is never cleared, so make sure the entry really points to this tile
+        int position = search->queue.positions.items[next_offset];
+        if (position < search->queue.tail && search->queue.items[position] == next_offset) {
+            index = position;
+            search->tick.heap_updates++;
         }
     } else {
-        queue.tail++;
+        touch(search, next_offset);
+        search->queue.tail++;
     }
-    distance.determined.items[next_offset] = current_dist;
-    distance.possible.items[next_offset] = possible_dist;
+    search->distance.determined.items[next_offset] = current_dist;
+    search->distance.possible.items[next_offset] = possible_dist;
+
+    ordered_queue_reduce_index(search, index, next_offset, possible_dist);
+}
+
+static inline int valid_offset(const routing_search *search, int grid_offset)
+{
+    return map_grid_is_valid_offset(grid_offset) && search->distance.determined.items[grid_offset] == 0;
+}
 
-    ordered_queue_reduce_index(index, next_offset, possible_dist);
+static inline int distance_left(const routing_search *search, int x, int y)
+{
+    return abs(search->distance.dst_x - x) + abs(search->distance.dst_y - y);
 }
 
-static inline int valid_offset(int grid_offset)
+static inline int chunk_of(int grid_offset)
 {
-    return map_grid_is_valid_offset(grid_offset) && distance.determined.items[grid_offset] == 0;
+    return (grid_offset / GRID_SIZE / CHUNK_SIZE) * CHUNKS_PER_ROW + (grid_offset % GRID_SIZE) / CHUNK_SIZE;
 }
 
-static inline int distance_left(int x, int y)
+static inline int in_corridor(const routing_search *search, int grid_offset)
 {
-    return abs(distance.dst_x - x) + abs(distance.dst_y - y);
+    return !search->hierarchy.active || search->hierarchy.corridor[chunk_of(grid_offset)];
 }
 
-static void route_queue_from_to(int src_x, int src_y, int dst_x, int dst_y, int max_tiles,
-    void (*callback)(int next_offset, int dist, int remaining_dist))
+static void route_queue_from_to(routing_search *search, int src_x, int src_y, int dst_x, int dst_y, int max_tiles,
+    void (*callback)(routing_search *search, int next_offset, int dist, int remaining_dist))
 {
-    clear_data();
-    distance.dst_x = dst_x;
-    distance.dst_y = dst_y;
+    clear_data(search);
+    search->tick.routes_calculated++;
+    search->distance.dst_x = dst_x;
+    search->distance.dst_y = dst_y;
     int dest = map_grid_offset(dst_x, dst_y);
-    ordered_enqueue(map_grid_offset(src_x, src_y), 1, 0);
+    ordered_enqueue(search, map_grid_offset(src_x, src_y), 1, 0);
     int tiles = 0;
-    while (queue.tail) {
-        int offset = ordered_queue_pop();
+    while (search->queue.tail) {
+        int offset = ordered_queue_pop(search);
         if (offset == dest || (max_tiles && ++tiles > max_tiles)) {
             break;
         }
+        search->tick.tiles_expanded++;
         int x = map_grid_offset_to_x(offset);
         int y = map_grid_offset_to_y(offset);
-        int dist = 1 + distance.determined.items[offset];
-        distance.possible.items[offset] = 1;
+        int dist = 1 + search->distance.determined.items[offset];
+        search->distance.possible.items[offset] = 1;
         for (int i = 0; i < 4; i++) {
-            if (valid_offset(offset + ROUTE_OFFSETS[i])) {
-                callback(offset + ROUTE_OFFSETS[i], dist,
-                    distance_left(x + ROUTE_OFFSETS_X[i], y + ROUTE_OFFSETS_Y[i]));
+            if (valid_offset(search, offset + ROUTE_OFFSETS[i]) && in_corridor(search, offset + ROUTE_OFFSETS[i])) {
+                callback(search, offset + ROUTE_OFFSETS[i], dist,
+                    distance_left(search, x + ROUTE_OFFSETS_X[i], y + ROUTE_OFFSETS_Y[i]));
             }
         }
     }
@@ -206,26 +293,28 @@ static void route_queue_from_to(int src_x, int src_y, int dst_x, int dst_y, int
 
 static void route_queue_all_from(int source, max_directions directions, int (*callback)(int next_offset, int dist), int is_boat)
 {
-    clear_data();
-    map_grid_clear_u8(water_drag.items);
-    enqueue(source, 1);
+    routing_search *search = &game_search;
+    clear_data(search);
+    search->tick.routes_calculated++;
+    enqueue(search, source, 1);
     int tiles = 0;
-    while (queue.head != queue.tail) {
+    while (search->queue.head != search->queue.tail) {
         if (++tiles > GUARD) {
             break;
         }
-        int offset = queue_pop();
+        search->tick.tiles_expanded++;
+        int offset = queue_pop(search);
         int drag = is_boat && terrain_water.items[offset] == WATER_N2_MAP_EDGE ? 4 : 0;
-        if (water_drag.items[offset] < drag) {
-            water_drag.items[offset]++;
-            queue.items[queue.tail++] = offset;
-            if (queue.tail >= MAX_QUEUE) {
-                queue.tail = 0;
+        if (search->water_drag.items[offset] < drag) {
+            search->water_drag.items[offset]++;
+            search->queue.items[search->queue.tail++] = offset;
+            if (search->queue.tail >= MAX_QUEUE) {
+                search->queue.tail = 0;
             }
         } else {
-            int dist = 1 + distance.determined.items[offset];
+            int dist = 1 + search->distance.determined.items[offset];
             for (int i = 0; i < directions; i++) {
-                if (valid_offset(offset + ROUTE_OFFSETS[i])) {
+                if (valid_offset(search, offset + ROUTE_OFFSETS[i])) {
                     if (callback(offset + ROUTE_OFFSETS[i], dist) == UNTIL_STOP) {
                         break;
                     }
@@ -238,7 +327,7 @@ static void route_queue_all_from(int source, max_directions directions, int (*ca
 static int callback_calc_distance(int next_offset, int dist)
 {
     if (terrain_land_citizen.items[next_offset] >= CITIZEN_0_ROAD) {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
     }
     return 1;
 }
@@ -253,9 +342,9 @@ static int callback_calc_distance_water_boat(int next_offset, int dist)
 {
     if (terrain_water.items[next_offset] != WATER_N1_BLOCKED &&
         terrain_water.items[next_offset] != WATER_N3_LOW_BRIDGE) {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
         if (terrain_water.items[next_offset] == WATER_N2_MAP_EDGE) {
-            distance.determined.items[next_offset] += 4;
+            game_search.distance.determined.items[next_offset] += 4;
         }
     }
     return 1;
@@ -265,7 +354,7 @@ void map_routing_calculate_distances_water_boat(int x, int y)
 {
     int grid_offset = map_grid_offset(x, y);
     if (terrain_water.items[grid_offset] == WATER_N1_BLOCKED) {
-        clear_data();
+        clear_data(&game_search);
     } else {
         route_queue_all_from(grid_offset, DIRECTIONS_NO_DIAGONALS, callback_calc_distance_water_boat, 1);
     }
@@ -274,7 +363,7 @@ void map_routing_calculate_distances_water_boat(int x, int y)
 static int callback_calc_distance_water_flotsam(int next_offset, int dist)
 {
     if (terrain_water.items[next_offset] != WATER_N1_BLOCKED) {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
     }
     return 1;
 }
@@ -283,7 +372,7 @@ void map_routing_calculate_distances_water_flotsam(int x, int y)
 {
     int grid_offset = map_grid_offset(x, y);
     if (terrain_water.items[grid_offset] == WATER_N1_BLOCKED) {
-        clear_data();
+        clear_data(&game_search);
     } else {
         route_queue_all_from(grid_offset, DIRECTIONS_DIAGONALS, callback_calc_distance_water_flotsam, 0);
     }
@@ -292,7 +381,7 @@ void map_routing_calculate_distances_water_flotsam(int x, int y)
 static int callback_calc_distance_build_wall(int next_offset, int dist)
 {
     if (terrain_land_citizen.items[next_offset] == CITIZEN_4_CLEAR_TERRAIN) {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
     }
     return 1;
 }
@@ -303,7 +392,7 @@ static int callback_calc_distance_build_road(int next_offset, int dist)
     switch (terrain_land_citizen.items[next_offset]) {
         case CITIZEN_N3_AQUEDUCT:
             if (!map_can_place_road_under_aqueduct(next_offset)) {
-                distance.determined.items[next_offset] = -1;
+                set_distance_blocked(&game_search, next_offset);
                 blocked = 1;
             }
             break;
@@ -318,7 +407,7 @@ static int callback_calc_distance_build_road(int next_offset, int dist)
             break;
     }
     if (!blocked) {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
     }
     return 1;
 }
@@ -341,11 +430,11 @@ static int callback_calc_distance_build_aqueduct(int next_offset, int dist)
             break;
     }
     if (map_terrain_is(next_offset, TERRAIN_ROAD) && !map_can_place_aqueduct_on_road(next_offset)) {
-        distance.determined.items[next_offset] = -1;
+        set_distance_blocked(&game_search, next_offset);
         blocked = 1;
     }
     if (!blocked) {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
     }
     return 1;
 }
@@ -390,7 +479,7 @@ int map_routing_calculate_distances_for_building(routed_building_type type, int
         route_queue_all_from(map_grid_offset(x, y), DIRECTIONS_NO_DIAGONALS, callback_calc_distance_build_wall, 0);
         return 1;
     }
-    clear_data();
+    clear_data(&game_search);
     int source_offset = map_grid_offset(x, y);
     if (!map_can_place_initial_road_or_aqueduct(source_offset, type != ROUTED_BUILDING_ROAD)) {
         return 0;
@@ -416,7 +505,7 @@ static int callback_delete_wall_aqueduct(int next_offset, int dist)
             return UNTIL_STOP;
         }
     } else {
-        enqueue(next_offset, dist);
+        enqueue(&game_search, next_offset, dist);
     }
     return UNTIL_CONTINUE;
 }
@@ -453,73 +542,211 @@ static inline int has_fighting_enemy(int grid_offset)
     return fighting_data.status.items[grid_offset] & 2;
 }
 
-static void callback_travel_citizen_land(int next_offset, int dist, int remaining_dist)
+static inline int chunk_graph_tile_passable(chunk_graph_type type, int grid_offset)
+{
+    int land = terrain_land_citizen.items[grid_offset];
+    if (type == CHUNK_GRAPH_CITIZEN_ROAD_GARDEN) {
+        return land >= CITIZEN_0_ROAD && land <= CITIZEN_2_PASSABLE_TERRAIN;
+    }
+    return land >= 0;
+}
+
+static const chunk_graph *get_chunk_graph(chunk_graph_type type)
+{
+    chunk_graph *graph = &chunk_graphs[type];
+    if (graph->is_valid && graph->terrain_version == map_routing_terrain_version()) {
+        return graph;
+    }
+    for (int i = 0; i < MAX_CHUNKS; i++) {
+        graph->chunks[i] = 0;
+    }
+    for (int y = 0; y < GRID_SIZE; y++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            int grid_offset = y * GRID_SIZE + x;
+            if (!chunk_graph_tile_passable(type, grid_offset)) {
+                continue;
+            }
+            int chunk = chunk_of(grid_offset);
+            graph->chunks[chunk] |= CHUNK_PASSABLE;
+            if (x + 1 < GRID_SIZE && (x + 1) % CHUNK_SIZE == 0 &&
+                chunk_graph_tile_passable(type, grid_offset + 1)) {
+                graph->chunks[chunk] |= CHUNK_LINK_RIGHT;
+            }
+            if (y + 1 < GRID_SIZE && (y + 1) % CHUNK_SIZE == 0 &&
+                chunk_graph_tile_passable(type, grid_offset + GRID_SIZE)) {
+                graph->chunks[chunk] |= CHUNK_LINK_DOWN;
+            }
+        }
+    }
+    graph->terrain_version = map_routing_terrain_version();
+    graph->is_valid = 1;
+    return graph;
+}
+
+static inline int chunks_linked(const chunk_graph *graph, int chunk, int direction)
+{
+    switch (direction) {
+        case 0: return chunk >= CHUNKS_PER_ROW && (graph->chunks[chunk - CHUNKS_PER_ROW] & CHUNK_LINK_DOWN);
+        case 1: return chunk % CHUNKS_PER_ROW < CHUNKS_PER_ROW - 1 && (graph->chunks[chunk] & CHUNK_LINK_RIGHT);
+        case 2: return chunk < MAX_CHUNKS - CHUNKS_PER_ROW && (graph->chunks[chunk] & CHUNK_LINK_DOWN);
+        default: return chunk % CHUNKS_PER_ROW > 0 && (graph->chunks[chunk - 1] & CHUNK_LINK_RIGHT);
+    }
+}
+
+static void mark_corridor_around(routing_search *search, int chunk)
+{
+    int chunk_x = chunk % CHUNKS_PER_ROW;
+    int chunk_y = chunk / CHUNKS_PER_ROW;
+    for (int y = chunk_y - 1; y <= chunk_y + 1; y++) {
+        for (int x = chunk_x - 1; x <= chunk_x + 1; x++) {
+            if (x >= 0 && y >= 0 && x < CHUNKS_PER_ROW && y < CHUNKS_PER_ROW) {
+                search->hierarchy.corridor[y * CHUNKS_PER_ROW + x] = 1;
+            }
+        }
+    }
+}
+
+/**
+ * Searches the chunk graph and marks the chunks along the found chunk path, plus their
+ * neighbours, as the corridor that the tile search is allowed to expand into
+ */
+static int find_chunk_corridor(routing_search *search, chunk_graph_type type, int src_offset, int dst_offset)
+{
+    const chunk_graph *graph = get_chunk_graph(type);
+    int src_chunk = chunk_of(src_offset);
+    int dst_chunk = chunk_of(dst_offset);
+    for (int i = 0; i < MAX_CHUNKS; i++) {
+        search->hierarchy.parent[i] = -1;
+        search->hierarchy.corridor[i] = 0;
+    }
+    int head = 0;
+    int tail = 0;
+    search->hierarchy.queue[tail++] = src_chunk;
+    search->hierarchy.parent[src_chunk] = src_chunk;
+    while (head < tail && search->hierarchy.parent[dst_chunk] < 0) {
+        int chunk = search->hierarchy.queue[head++];
+        for (int d = 0; d < 4; d++) {
+            if (!chunks_linked(graph, chunk, d)) {
+                continue;
+            }
+            int next = chunk + (d == 0 ? -CHUNKS_PER_ROW : d == 1 ? 1 : d == 2 ? CHUNKS_PER_ROW : -1);
+            if (search->hierarchy.parent[next] < 0) {
+                search->hierarchy.parent[next] = chunk;
+                search->hierarchy.queue[tail++] = next;
+            }
+        }
+    }
+    if (search->hierarchy.parent[dst_chunk] < 0) {
+        return 0;
+    }
+    for (int chunk = dst_chunk; chunk != src_chunk; chunk = search->hierarchy.parent[chunk]) {
+        mark_corridor_around(search, chunk);
+    }
+    mark_corridor_around(search, src_chunk);
+    return 1;
+}
+
+static int is_long_route(int src_x, int src_y, int dst_x, int dst_y)
+{
+    return abs(src_x - dst_x) + abs(src_y - dst_y) >= LONG_ROUTE_DISTANCE;
+}
+
+/**
+ * Routes citizens over long distances through the chunk graph first. The tile search is limited
+ * to the corridor of chunks found, and only falls back to a full search if that fails.
+ * Paths found this way may differ from the classic ones, so it is only used when
+ * deterministic routing is disabled.
+ */
+static void route_citizen_from_to(routing_search *search, chunk_graph_type type,
+    int src_x, int src_y, int dst_x, int dst_y,
+    void (*callback)(routing_search *search, int next_offset, int dist, int remaining_dist))
+{
+    if (!config_get(CONFIG_GP_DETERMINISTIC_ROUTING) && is_long_route(src_x, src_y, dst_x, dst_y)) {
+        int dst_offset = map_grid_offset(dst_x, dst_y);
+        if (find_chunk_corridor(search, type, map_grid_offset(src_x, src_y), dst_offset)) {
+            search->hierarchy.active = 1;
+            route_queue_from_to(search, src_x, src_y, dst_x, dst_y, 0, callback);
+            search->hierarchy.active = 0;
+            if (search->distance.determined.items[dst_offset]) {
+                return;
+            }
+        }
+    }
+    route_queue_from_to(search, src_x, src_y, dst_x, dst_y, 0, callback);
+}
+
+static void callback_travel_citizen_land(routing_search *search, int next_offset, int dist, int remaining_dist)
 {
     if (terrain_land_citizen.items[next_offset] >= 0 && !has_fighting_friendly(next_offset)) {
-        ordered_enqueue(next_offset, dist, remaining_dist);
+        ordered_enqueue(search, next_offset, dist, remaining_dist);
     }
 }
 
 int map_routing_citizen_can_travel_over_land(int src_x, int src_y, int dst_x, int dst_y)
 {
     ++stats.total_routes_calculated;
-    route_queue_from_to(src_x, src_y, dst_x, dst_y, 0, callback_travel_citizen_land);
-    return distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
+    reset_fighting_status();
+    route_citizen_from_to(&game_search, CHUNK_GRAPH_CITIZEN_LAND, src_x, src_y, dst_x, dst_y,
+        callback_travel_citizen_land);
+    return game_search.distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
+}
+
+static inline int is_road_or_garden(int grid_offset)
+{
+    return terrain_land_citizen.items[grid_offset] >= CITIZEN_0_ROAD &&
+        terrain_land_citizen.items[grid_offset] <= CITIZEN_2_PASSABLE_TERRAIN;
 }
 
-static void callback_travel_citizen_road_garden(int next_offset, int dist, int remaining_dist)
+static void callback_travel_citizen_road_garden(routing_search *search, int next_offset, int dist, int remaining_dist)
 {
-    if (terrain_land_citizen.items[next_offset] >= CITIZEN_0_ROAD &&
-        terrain_land_citizen.items[next_offset] <= CITIZEN_2_PASSABLE_TERRAIN) {
-        ordered_enqueue(next_offset, dist, remaining_dist);
+    if (is_road_or_garden(next_offset)) {
+        ordered_enqueue(search, next_offset, dist, remaining_dist);
     }
 }
 
 int map_routing_citizen_can_travel_over_road_garden(int src_x, int src_y, int dst_x, int dst_y)
 {
-    int dst_offset = map_grid_offset(dst_x, dst_y);
-    if (terrain_land_citizen.items[dst_offset] < CITIZEN_0_ROAD ||
-        terrain_land_citizen.items[dst_offset] > CITIZEN_2_PASSABLE_TERRAIN) {
+    if (!is_road_or_garden(map_grid_offset(dst_x, dst_y))) {
         return 0;
     }
     ++stats.total_routes_calculated;
-    route_queue_from_to(src_x, src_y, dst_x, dst_y, 0, callback_travel_citizen_road_garden);
-    return distance.determined.items[dst_offset] != 0;
+    return map_routing_search_citizen_road_garden(&game_search, src_x, src_y, dst_x, dst_y);
 }
 
-static void callback_travel_walls(int next_offset, int dist, int remaining_dist)
+static void callback_travel_walls(routing_search *search, int next_offset, int dist, int remaining_dist)
 {
     if (terrain_walls.items[next_offset] >= WALL_0_PASSABLE &&
         terrain_walls.items[next_offset] <= 2) {
-        ordered_enqueue(next_offset, dist, remaining_dist);
+        ordered_enqueue(search, next_offset, dist, remaining_dist);
     }
 }
 
 int map_routing_can_travel_over_walls(int src_x, int src_y, int dst_x, int dst_y)
 {
     ++stats.total_routes_calculated;
-    route_queue_from_to(src_x, src_y, dst_x, dst_y, 0, callback_travel_walls);
-    return distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
+    route_queue_from_to(&game_search, src_x, src_y, dst_x, dst_y, 0, callback_travel_walls);
+    return game_search.distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
 }
 
-static void callback_travel_noncitizen_land_through_building(int next_offset, int dist, int remaining_dist)
+static void callback_travel_noncitizen_land_through_building(routing_search *search,
+    int next_offset, int dist, int remaining_dist)
 {
     if (!has_fighting_enemy(next_offset)) {
         if (terrain_land_noncitizen.items[next_offset] == NONCITIZEN_0_PASSABLE ||
             terrain_land_noncitizen.items[next_offset] == NONCITIZEN_2_CLEARABLE ||
             (terrain_land_noncitizen.items[next_offset] == NONCITIZEN_1_BUILDING &&
             map_building_at(next_offset) == state.through_building_id)) {
-            ordered_enqueue(next_offset, dist, remaining_dist);
+            ordered_enqueue(search, next_offset, dist, remaining_dist);
         }
     }
 }
 
-static void callback_travel_noncitizen_land(int next_offset, int dist, int remaining_dist)
+static void callback_travel_noncitizen_land(routing_search *search, int next_offset, int dist, int remaining_dist)
 {
     if (!has_fighting_enemy(next_offset)) {
         if (terrain_land_noncitizen.items[next_offset] >= NONCITIZEN_0_PASSABLE &&
             terrain_land_noncitizen.items[next_offset] < NONCITIZEN_5_FORT) {
-            ordered_enqueue(next_offset, dist, remaining_dist);
+            ordered_enqueue(search, next_offset, dist, remaining_dist);
         }
     }
 }
@@ -529,27 +756,63 @@ int map_routing_noncitizen_can_travel_over_land(
 {
     ++stats.total_routes_calculated;
     ++stats.enemy_routes_calculated;
+    reset_fighting_status();
     if (only_through_building_id) {
         state.through_building_id = only_through_building_id;
-        route_queue_from_to(src_x, src_y, dst_x, dst_y, 0, callback_travel_noncitizen_land_through_building);
+        route_queue_from_to(&game_search, src_x, src_y, dst_x, dst_y, 0,
+            callback_travel_noncitizen_land_through_building);
     } else {
-        route_queue_from_to(src_x, src_y, dst_x, dst_y, max_tiles, callback_travel_noncitizen_land);
+        route_queue_from_to(&game_search, src_x, src_y, dst_x, dst_y, max_tiles, callback_travel_noncitizen_land);
     }
-    return distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
+    return game_search.distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
 }
 
-static void callback_travel_noncitizen_through_everything(int next_offset, int dist, int remaining_dist)
+static void callback_travel_noncitizen_through_everything(routing_search *search,
+    int next_offset, int dist, int remaining_dist)
 {
     if (terrain_land_noncitizen.items[next_offset] >= NONCITIZEN_0_PASSABLE) {
-        ordered_enqueue(next_offset, dist, remaining_dist);
+        ordered_enqueue(search, next_offset, dist, remaining_dist);
     }
 }
 
 int map_routing_noncitizen_can_travel_through_everything(int src_x, int src_y, int dst_x, int dst_y)
 {
     ++stats.total_routes_calculated;
-    route_queue_from_to(src_x, src_y, dst_x, dst_y, 0, callback_travel_noncitizen_through_everything);
-    return distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
+    route_queue_from_to(&game_search, src_x, src_y, dst_x, dst_y, 0, callback_travel_noncitizen_through_everything);
+    return game_search.distance.determined.items[map_grid_offset(dst_x, dst_y)] != 0;
+}
+
+routing_search *map_routing_search_create(void)
+{
+    return calloc(1, sizeof(routing_search));
+}
+
+void map_routing_search_prepare(void)
+{
+    if (!config_get(CONFIG_GP_DETERMINISTIC_ROUTING)) {
+        get_chunk_graph(CHUNK_GRAPH_CITIZEN_ROAD_GARDEN);
+    }
+}
+
+int map_routing_search_citizen_road_garden(routing_search *search, int src_x, int src_y, int dst_x, int dst_y)
+{
+    int dst_offset = map_grid_offset(dst_x, dst_y);
+    if (!is_road_or_garden(dst_offset)) {
+        return 0;
+    }
+    route_citizen_from_to(search, CHUNK_GRAPH_CITIZEN_ROAD_GARDEN, src_x, src_y, dst_x, dst_y,
+        callback_travel_citizen_road_garden);
+    return search->distance.determined.items[dst_offset] != 0;
+}
+
+int map_routing_search_distance(const routing_search *search, int grid_offset)
+{
+    return search->distance.determined.items[grid_offset];
+}
+
+void map_routing_count_cached_route(void)
+{
+    ++stats.total_routes_calculated;
 }
 
 void map_routing_block(int x, int y, int size)
@@ -559,14 +822,26 @@ void map_routing_block(int x, int y, int size)
     }
     for (int dy = 0; dy < size; dy++) {
         for (int dx = 0; dx < size; dx++) {
-            distance.determined.items[map_grid_offset(x + dx, y + dy)] = 0;
+            game_search.distance.determined.items[map_grid_offset(x + dx, y + dy)] = 0;
         }
     }
 }
 
 int map_routing_distance(int grid_offset)
 {
-    return distance.determined.items[grid_offset];
+    return game_search.distance.determined.items[grid_offset];
+}
+
+void map_routing_reset_tick_stats(void)
+{
+    game_search.tick.routes_calculated = 0;
+    game_search.tick.tiles_expanded = 0;
+    game_search.tick.heap_updates = 0;
+}
+
+const routing_tick_stats *map_routing_get_tick_stats(void)
+{
+    return &game_search.tick;
 }
 
 void map_routing_save_state(buffer *buf)
@@ -10,6 +10,17 @@ typedef enum {
     ROUTED_BUILDING_AQUEDUCT_WITHOUT_GRAPHIC = 4,
 } routed_building_type;
 
+typedef struct {
+    int routes_calculated;
+    int tiles_expanded;
+    int heap_updates;
+} routing_tick_stats;
+
+/**
+ * Memory for route searches. The functions below without a search use the one of the game thread.
+ */
+typedef struct routing_search routing_search;
+
 void map_routing_calculate_distances(int x, int y);
 void map_routing_calculate_distances_water_boat(int x, int y);
 void map_routing_calculate_distances_water_flotsam(int x, int y);
@@ -28,8 +39,47 @@ int map_routing_noncitizen_can_travel_over_land(
     int src_x, int src_y, int dst_x, int dst_y, int only_through_building_id, int max_tiles);
 int map_routing_noncitizen_can_travel_through_everything(int src_x, int src_y, int dst_x, int dst_y);
 
+/**
+ * Counts a route that was served from a cache as calculated, so the saved counters
+ * stay the same as when the route is searched for
+ */
+void map_routing_count_cached_route(void);
+
 void map_routing_block(int x, int y, int size);
 
+/**
+ * Creates the memory for route searches on another thread
+ * @return The search memory, or 0 if it could not be allocated
+ */
+routing_search *map_routing_search_create(void);
+
+/**
+ * Prepares the data that all searches share, so that searches on other threads only read it.
+ * Must be called on the game thread before starting the searches.
+ */
+void map_routing_search_prepare(void);
+
+/**
+ * Same as map_routing_citizen_can_travel_over_road_garden, but with the given search memory.
+ * Changes no game state, so it can run on another thread while the game thread waits.
+ * @param search Search memory for this thread
+ * @return 1 if there is a route, 0 otherwise
+ */
+int map_routing_search_citizen_road_garden(routing_search *search, int src_x, int src_y, int dst_x, int dst_y);
+
+int map_routing_search_distance(const routing_search *search, int grid_offset);
+
+/**
+ * Resets the routing counters for the current tick
+ */
+void map_routing_reset_tick_stats(void);
+
+/**
+ * Gets the routing counters since the start of the current tick, for searches on the game thread
+ * @return Routing counters: searches, expanded tiles and decrease-key heap updates
+ */
+const routing_tick_stats *map_routing_get_tick_stats(void);
+
 void map_routing_save_state(buffer *buf);
 
 void map_routing_load_state(buffer *buf);
@@ -8,8 +8,6 @@
 
 #define MAX_PATH 500
 
-static int direction_path[MAX_PATH];
-
 static void adjust_tile_in_direction(int direction, int *x, int *y, int *grid_offset)
 {
     switch (direction) {
@@ -45,10 +43,17 @@ static void adjust_tile_in_direction(int direction, int *x, int *y, int *grid_of
     *grid_offset += map_grid_direction_delta(direction);
 }
 
-int map_routing_get_path(uint8_t *path, int src_x, int src_y, int dst_x, int dst_y, int num_directions)
+static int distance_at(const routing_search *search, int grid_offset)
+{
+    return search ? map_routing_search_distance(search, grid_offset) : map_routing_distance(grid_offset);
+}
+
+static int get_path(const routing_search *search, uint8_t *path,
+    int src_x, int src_y, int dst_x, int dst_y, int num_directions)
 {
+    int direction_path[MAX_PATH];
     int dst_grid_offset = map_grid_offset(dst_x, dst_y);
-    int distance = map_routing_distance(dst_grid_offset);
+    int distance = distance_at(search, dst_grid_offset);
     if (distance <= 0 || distance >= 998) {
         return 0;
     }
@@ -61,13 +66,13 @@ int map_routing_get_path(uint8_t *path, int src_x, int src_y, int dst_x, int dst
     int step = num_directions == 8 ? 1 : 2;
 
     while (distance > 1) {
-        distance = map_routing_distance(grid_offset);
+        distance = distance_at(search, grid_offset);
         int direction = -1;
         int general_direction = calc_general_direction(x, y, src_x, src_y);
         for (int d = 0; d < 8; d += step) {
             if (d != last_direction) {
                 int next_offset = grid_offset + map_grid_direction_delta(d);
-                int next_distance = map_routing_distance(next_offset);
+                int next_distance = distance_at(search, next_offset);
                 if (next_distance) {
                     if (next_distance < distance) {
                         distance = next_distance;
@@ -96,8 +101,20 @@ int map_routing_get_path(uint8_t *path, int src_x, int src_y, int dst_x, int dst
     return num_tiles;
 }
 
+int map_routing_get_path(uint8_t *path, int src_x, int src_y, int dst_x, int dst_y, int num_directions)
+{
+    return get_path(0, path, src_x, src_y, dst_x, dst_y, num_directions);
+}
+
+int map_routing_search_get_path(const routing_search *search, uint8_t *path,
+    int src_x, int src_y, int dst_x, int dst_y, int num_directions)
+{
+    return get_path(search, path, src_x, src_y, dst_x, dst_y, num_directions);
+}
+
 int map_routing_get_path_on_water(uint8_t *path, int dst_x, int dst_y, int is_flotsam)
 {
+    int direction_path[MAX_PATH];
     int rand = random_byte() & 3;
     int dst_grid_offset = map_grid_offset(dst_x, dst_y);
     int distance = map_routing_distance(dst_grid_offset);
@@ -13,8 +13,17 @@
 #include "map/sprite.h"
 #include "map/terrain.h"
 
+static struct {
+    int version;
+} data;
+
 static void map_routing_update_land_noncitizen(void);
 
+int map_routing_terrain_version(void)
+{
+    return data.version;
+}
+
 void map_routing_update_all(void)
 {
     map_routing_update_land();
@@ -113,6 +122,7 @@ static int get_land_type_citizen_aqueduct(int grid_offset)
 
 void map_routing_update_land_citizen(void)
 {
+    data.version++;
     map_grid_init_i8(terrain_land_citizen.items, -1);
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
@@ -180,6 +190,7 @@ static int get_land_type_noncitizen(int grid_offset)
 
 static void map_routing_update_land_noncitizen(void)
 {
+    data.version++;
     map_grid_init_i8(terrain_land_noncitizen.items, -1);
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
@@ -216,6 +227,7 @@ static int is_surrounded_by_water(int grid_offset)
 
 void map_routing_update_water(void)
 {
+    data.version++;
     map_grid_init_i8(terrain_water.items, -1);
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
@@ -280,6 +292,7 @@ static int count_adjacent_wall_tiles(int grid_offset)
 
 void map_routing_update_walls(void)
 {
+    data.version++;
     map_grid_init_i8(terrain_walls.items, -1);
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
@@ -7,6 +7,12 @@ void map_routing_update_land_citizen(void);
 void map_routing_update_water(void);
 void map_routing_update_walls(void);
 
+/**
+ * Gets the routing terrain version, which changes every time one of the routing grids is rebuilt
+ * @return Routing terrain version
+ */
+int map_routing_terrain_version(void);
+
 int map_routing_is_wall_passable(int grid_offset);
 int map_routing_wall_tile_in_radius(int x, int y, int radius, int *x_wall, int *y_wall);
 
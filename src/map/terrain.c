@@ -4,9 +4,28 @@
 #include "map/ring.h"
 #include "map/routing.h"
 
+// Changes to these types are counted, so that the water supply is only recalculated when it can change
+#define WATER_SUPPLY_TERRAIN (TERRAIN_WATER | TERRAIN_AQUEDUCT | TERRAIN_RESERVOIR_RANGE | TERRAIN_FOUNTAIN_RANGE)
+
 static grid_u16 terrain_grid;
 static grid_u16 terrain_grid_backup;
 
+static struct {
+    int water_supply_version;
+} data;
+
+static void track_change(int old_terrain, int new_terrain)
+{
+    if ((old_terrain ^ new_terrain) & WATER_SUPPLY_TERRAIN) {
+        data.water_supply_version++;
+    }
+}
+
+int map_terrain_water_supply_version(void)
+{
+    return data.water_supply_version;
+}
+
 int map_terrain_is(int grid_offset, int terrain)
 {
     return map_grid_is_valid_offset(grid_offset) && terrain_grid.items[grid_offset] & terrain;
@@ -24,16 +43,19 @@ int map_terrain_get(int grid_offset)
 
 void map_terrain_set(int grid_offset, int terrain)
 {
+    track_change(terrain_grid.items[grid_offset], terrain);
     terrain_grid.items[grid_offset] = terrain;
 }
 
 void map_terrain_add(int grid_offset, int terrain)
 {
+    track_change(terrain_grid.items[grid_offset], terrain_grid.items[grid_offset] | terrain);
     terrain_grid.items[grid_offset] |= terrain;
 }
 
 void map_terrain_remove(int grid_offset, int terrain)
 {
+    track_change(terrain_grid.items[grid_offset], terrain_grid.items[grid_offset] & ~terrain);
     terrain_grid.items[grid_offset] &= ~terrain;
 }
 
@@ -63,6 +85,7 @@ void map_terrain_remove_with_radius(int x, int y, int size, int radius, int terr
 
 void map_terrain_remove_all(int terrain)
 {
+    track_change(0, terrain);
     map_grid_and_u16(terrain_grid.items, ~terrain);
 }
 
@@ -354,11 +377,13 @@ void map_terrain_backup(void)
 
 void map_terrain_restore(void)
 {
+    data.water_supply_version++;
     map_grid_copy_u16(terrain_grid_backup.items, terrain_grid.items);
 }
 
 void map_terrain_clear(void)
 {
+    data.water_supply_version++;
     map_grid_clear_u16(terrain_grid.items);
 }
 
@@ -372,6 +397,7 @@ void map_terrain_init_outside_map(void)
         int y_outside_map = y < y_start || y >= y_start + map_height;
         for (int x = 0; x < GRID_SIZE; x++) {
             if (y_outside_map || x < x_start || x >= x_start + map_width) {
+                track_change(terrain_grid.items[x + GRID_SIZE * y], TERRAIN_TREE | TERRAIN_WATER);
                 terrain_grid.items[x + GRID_SIZE * y] = TERRAIN_TREE | TERRAIN_WATER;
             }
         }
@@ -385,5 +411,6 @@ void map_terrain_save_state(buffer *buf)
 
 void map_terrain_load_state(buffer *buf)
 {
+    data.water_supply_version++;
     map_grid_load_state_u16(terrain_grid.items, buf);
 }
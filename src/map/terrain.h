@@ -50,6 +50,12 @@ void map_terrain_remove_with_radius(int x, int y, int size, int radius, int terr
 
 void map_terrain_remove_all(int terrain);
 
+/**
+ * Gets a number that changes every time water, aqueduct, reservoir range or fountain range terrain changes
+ * @return Water supply terrain version
+ */
+int map_terrain_water_supply_version(void);
+
 /**
  * Check orthogonal neighbours of a tile if they contain a terrain.
  * @param grid_offset Tile which neighbours will be checked.
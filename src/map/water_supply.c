@@ -25,9 +25,27 @@
 #define RESERVOIR_RADIUS 10
 #define WELL_RADIUS 2
 #define FOUNTAIN_RADIUS 4
+#define MAX_TRACKED_RESERVOIRS 100
 
 static const int ADJACENT_OFFSETS[] = { -GRID_SIZE, 1, GRID_SIZE, -1 };
 
+static struct {
+    int is_valid;
+    int aqueduct_version;
+    int terrain_version;
+    int image_without_water;
+    int num_reservoirs;
+    struct {
+        int id;
+        int state;
+        int has_water_access;
+    } reservoirs[MAX_TRACKED_RESERVOIRS];
+    int reservoir_radius;
+    int neptune_id;
+    int fountain_radius;
+    int num_fountains_with_water;
+} data;
+
 static struct {
     int items[MAX_QUEUE];
     int head;
@@ -145,10 +163,47 @@ static void fill_aqueducts_from_offset(int grid_offset)
     } while (next_offset > -1);
 }
 
-void map_water_supply_update_reservoir_fountain(void)
+static int reservoirs_unchanged(void)
+{
+    int index = 0;
+    for (building *b = building_first_of_type(BUILDING_RESERVOIR); b; b = b->next_of_type) {
+        if (index >= data.num_reservoirs || data.reservoirs[index].id != b->id ||
+            data.reservoirs[index].state != b->state ||
+            data.reservoirs[index].has_water_access != b->has_water_access) {
+            return 0;
+        }
+        index++;
+    }
+    return index == data.num_reservoirs;
+}
+
+static void remember_reservoirs(void)
+{
+    data.num_reservoirs = 0;
+    for (building *b = building_first_of_type(BUILDING_RESERVOIR); b; b = b->next_of_type) {
+        if (data.num_reservoirs >= MAX_TRACKED_RESERVOIRS) {
+            // too many to remember: always recalculate
+            data.num_reservoirs = -1;
+            return;
+        }
+        data.reservoirs[data.num_reservoirs].id = b->id;
+        data.reservoirs[data.num_reservoirs].state = b->state;
+        data.reservoirs[data.num_reservoirs].has_water_access = b->has_water_access;
+        data.num_reservoirs++;
+    }
+}
+
+static int aqueducts_unchanged(void)
+{
+    return data.is_valid &&
+        data.aqueduct_version == map_aqueduct_version() &&
+        data.terrain_version == map_terrain_water_supply_version() &&
+        data.image_without_water == image_group(GROUP_BUILDING_AQUEDUCT_NO_WATER) &&
+        reservoirs_unchanged();
+}
+
+static void update_aqueducts(void)
 {
-    map_terrain_remove_all(TERRAIN_FOUNTAIN_RANGE | TERRAIN_RESERVOIR_RANGE);
-    // reservoirs
     set_all_aqueducts_to_no_water();
     for (building *b = building_first_of_type(BUILDING_RESERVOIR); b; b = b->next_of_type) {
         if (b->state != BUILDING_STATE_IN_USE) {
@@ -178,20 +233,61 @@ void map_water_supply_update_reservoir_fountain(void)
             }
         }
     }
-    // mark reservoir ranges
+    data.aqueduct_version = map_aqueduct_version();
+    data.image_without_water = image_group(GROUP_BUILDING_AQUEDUCT_NO_WATER);
+    remember_reservoirs();
+}
+
+static void add_reservoir_ranges(void)
+{
+    map_terrain_remove_all(TERRAIN_RESERVOIR_RANGE);
     for (building *b = building_first_of_type(BUILDING_RESERVOIR); b; b = b->next_of_type) {
         if (b->state == BUILDING_STATE_IN_USE && b->has_water_access) {
-            map_terrain_add_with_radius(b->x, b->y, 3, map_water_supply_reservoir_radius(), TERRAIN_RESERVOIR_RANGE);
+            map_terrain_add_with_radius(b->x, b->y, 3, data.reservoir_radius, TERRAIN_RESERVOIR_RANGE);
         }
     }
 
     // Neptune GT module 2 bonus
-    if (building_monument_gt_module_is_active(NEPTUNE_MODULE_2_CAPACITY_AND_WATER)) {
-        building *b = building_get(building_monument_get_neptune_gt());
-        map_terrain_add_with_radius(b->x, b->y, 7, map_water_supply_reservoir_radius(), TERRAIN_RESERVOIR_RANGE);
+    if (data.neptune_id) {
+        building *b = building_get(data.neptune_id);
+        map_terrain_add_with_radius(b->x, b->y, 7, data.reservoir_radius, TERRAIN_RESERVOIR_RANGE);
+    }
+}
+
+static void add_fountain_ranges(void)
+{
+    map_terrain_remove_all(TERRAIN_FOUNTAIN_RANGE);
+    for (building *b = building_first_of_type(BUILDING_FOUNTAIN); b; b = b->next_of_type) {
+        if (b->state == BUILDING_STATE_IN_USE && b->has_water_access) {
+            map_terrain_add_with_radius(b->x, b->y, 1, data.fountain_radius, TERRAIN_FOUNTAIN_RANGE);
+        }
+    }
+}
+
+void map_water_supply_update_reservoir_fountain(void)
+{
+    // The ranges are the union of the ranges of all sources, so they only need
+    // to be redrawn when a source or the terrain under them changed
+    int ranges_changed = !data.is_valid || data.terrain_version != map_terrain_water_supply_version();
+    if (!aqueducts_unchanged()) {
+        update_aqueducts();
+        ranges_changed = 1;
+    }
+
+    // mark reservoir ranges
+    int reservoir_radius = map_water_supply_reservoir_radius();
+    int neptune_id = building_monument_gt_module_is_active(NEPTUNE_MODULE_2_CAPACITY_AND_WATER) ?
+        building_monument_get_neptune_gt() : 0;
+    if (ranges_changed || reservoir_radius != data.reservoir_radius || neptune_id != data.neptune_id) {
+        data.reservoir_radius = reservoir_radius;
+        data.neptune_id = neptune_id;
+        add_reservoir_ranges();
+        ranges_changed = 1;
     }
 
     // fountains
+    int fountain_radius = map_water_supply_fountain_radius();
+    int num_fountains_with_water = 0;
     for (building *b = building_first_of_type(BUILDING_FOUNTAIN); b; b = b->next_of_type) {
         if (b->state != BUILDING_STATE_IN_USE) {
             continue;
@@ -212,14 +308,22 @@ void map_water_supply_update_reservoir_fountain(void)
             b->upgrade_level = 0;
         }
         map_building_tiles_add(b->id, b->x, b->y, 1, image_id, TERRAIN_BUILDING);
-        if (map_terrain_is(b->grid_offset, TERRAIN_RESERVOIR_RANGE) && b->num_workers) {
-            b->has_water_access = 1;
-            map_terrain_add_with_radius(b->x, b->y, 1,
-                map_water_supply_fountain_radius(), TERRAIN_FOUNTAIN_RANGE);
-        } else {
-            b->has_water_access = 0;
+        int has_water_access = map_terrain_is(b->grid_offset, TERRAIN_RESERVOIR_RANGE) && b->num_workers;
+        if (b->has_water_access != has_water_access) {
+            b->has_water_access = has_water_access;
+            ranges_changed = 1;
         }
+        num_fountains_with_water += has_water_access;
     }
+    if (ranges_changed || fountain_radius != data.fountain_radius ||
+        num_fountains_with_water != data.num_fountains_with_water) {
+        data.fountain_radius = fountain_radius;
+        data.num_fountains_with_water = num_fountains_with_water;
+        add_fountain_ranges();
+    }
+    data.terrain_version = map_terrain_water_supply_version();
+    data.is_valid = 1;
+
     // Ponds
     static const building_type ponds[] = { BUILDING_SMALL_POND, BUILDING_LARGE_POND };
     for (int i = 0; i < 2; i++) {
@@ -19,6 +19,7 @@
 #include "platform/prefs.h"
 #include "platform/screen.h"
 #include "platform/touch.h"
+#include "platform/worker_threads.h"
 
 #include "tinyfiledialogs/tinyfiledialogs.h"
 
@@ -40,9 +41,12 @@
 #endif
 
 #ifdef DRAW_FPS
+#include "game/profiler.h"
 #include "graphics/window.h"
 #include "graphics/graphics.h"
 #include "graphics/text.h"
+
+#define PROFILER_OVERLAY_SECTIONS 3
 #endif
 
 #define INTPTR(d) (*(int*)(d))
@@ -151,6 +155,27 @@ static struct {
     Uint32 last_update_time;
 } fps = { 0, 0, 0 };
 
+static uint64_t profiler_clock(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+static void draw_profiler_overlay(int y_offset)
+{
+    int sections[PROFILER_OVERLAY_SECTIONS];
+    int num_sections = profiler_get_worst_sections(sections, PROFILER_OVERLAY_SECTIONS);
+    if (!num_sections) {
+        return;
+    }
+    graphics_fill_rect(0, y_offset, 300, 20 * num_sections, COLOR_WHITE);
+    for (int i = 0; i < num_sections; i++) {
+        char text[64];
+        snprintf(text, sizeof(text), "%.2f ms %s",
+            profiler_to_millis(profiler_get_recent_max(sections[i])), profiler_section_name(sections[i]));
+        text_draw((const uint8_t *) text, 5, y_offset + 20 * i + 5, FONT_NORMAL_PLAIN, COLOR_FONT_RED);
+    }
+}
+
 static void run_and_draw(void)
 {
     time_millis time_before_run = SDL_GetTicks();
@@ -177,6 +202,7 @@ static void run_and_draw(void)
             'g', "", 40, y_offset_text, FONT_NORMAL_PLAIN, COLOR_FONT_RED);
         text_draw_number_colored(time_after_draw - time_between_run_and_draw,
             'd', "", 70, y_offset_text, FONT_NORMAL_PLAIN, COLOR_FONT_RED);
+        draw_profiler_overlay(y_offset + 20);
     }
     platform_screen_update();
     platform_screen_render();
@@ -246,6 +272,14 @@ static void handle_event(SDL_Event *event)
         case SDL_WINDOWEVENT:
             handle_window_event(&event->window, &data.active);
             break;
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+        case SDL_RENDER_DEVICE_RESET:
+#endif
+#if SDL_VERSION_ATLEAST(2, 0, 2)
+        case SDL_RENDER_TARGETS_RESET:
+            platform_screen_invalidate_textures();
+            break;
+#endif
         case SDL_KEYDOWN:
             platform_handle_key_down(&event->key);
             break;
@@ -335,6 +369,7 @@ static void teardown(void)
 {
     SDL_Log("Exiting game");
     game_exit();
+    platform_worker_threads_stop();
     platform_screen_destroy();
     SDL_Quit();
     teardown_logging();
@@ -518,6 +553,7 @@ static void setup(const julius_args *args)
         SDL_Log("Exiting: SDL init failed");
         exit_with_status(-1);
     }
+    platform_worker_threads_start();
 
     if (!pre_init(args->data_directory)) {
         SDL_Log("Exiting: game pre-init failed");
@@ -553,6 +589,9 @@ static void setup(const julius_args *args)
 #endif
 
     time_set_millis(SDL_GetTicks());
+#ifdef DRAW_FPS
+    profiler_set_clock(profiler_clock, SDL_GetPerformanceFrequency());
+#endif
 
     if (!game_init()) {
         SDL_Log("Exiting: game init failed");
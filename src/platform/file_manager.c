@@ -1,6 +1,7 @@
 #include "file_manager.h"
 
 #include "assets/assets.h"
+#include "core/dir.h"
 #include "core/file.h"
 #include "core/log.h"
 #include "core/string.h"
@@ -317,6 +318,16 @@ int platform_file_manager_should_case_correct_file(void)
 #endif
 }
 
+int platform_file_manager_can_rename_file(void)
+{
+#ifdef __ANDROID__
+    // Files are accessed through descriptors handed out by the system, which has no rename
+    return 0;
+#else
+    return 1;
+#endif
+}
+
 int platform_file_manager_compare_filename(const char *a, const char *b)
 {
 #if _MSC_VER
@@ -341,6 +352,7 @@ int platform_file_manager_set_base_path(const char *path)
         log_error("set_base_path: path was not set. Augustus will probably crash.", 0, 0);
         return 0;
     }
+    dir_clear_cache();
 #ifdef __ANDROID__
     return android_set_base_path(path);
 #else
@@ -377,6 +389,23 @@ int platform_file_manager_remove_file(const char *filename)
     return remove(vita_prepend_path(filename)) == 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    char path[2 * FILE_NAME_MAX] = { 0 };
+    strncpy(path, vita_prepend_path(filename), 2 * FILE_NAME_MAX - 1);
+    const char *new_path = vita_prepend_path(new_filename);
+    if (rename(path, new_path) != 0 && (remove(new_path) != 0 || rename(path, new_path) != 0)) {
+        return 0;
+    }
+    platform_file_manager_cache_delete_file_info(filename);
+    char temp_filename[FILE_NAME_MAX];
+    strncpy(temp_filename, new_filename, FILE_NAME_MAX - 1);
+    if (!file_exists(temp_filename, NOT_LOCALIZED)) {
+        platform_file_manager_cache_add_file_info(new_filename);
+    }
+    return 1;
+}
+
 #elif defined(_WIN32)
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -416,6 +445,17 @@ int platform_file_manager_remove_file(const char *filename)
     return result == 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    wchar_t *wfile = utf8_to_wchar(filename);
+    wchar_t *wnew_file = utf8_to_wchar(new_filename);
+    // Unlike _wrename, replaces the file with the new name if it exists
+    int result = MoveFileExW(wfile, wnew_file, MOVEFILE_REPLACE_EXISTING);
+    free(wfile);
+    free(wnew_file);
+    return result != 0;
+}
+
 #elif defined(__ANDROID__)
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -437,6 +477,11 @@ int platform_file_manager_remove_file(const char *filename)
     return android_remove_file(filename);
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    return 0;
+}
+
 #elif defined(__EMSCRIPTEN__)
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -456,6 +501,17 @@ int platform_file_manager_remove_file(const char *filename)
     return 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    if (rename(filename, new_filename) == 0) {
+        EM_ASM(
+            Module.syncFS();
+        );
+        return 1;
+    }
+    return 0;
+}
+
 FILE *platform_file_manager_open_asset(const char *asset, const char *mode)
 {
     get_assets_directory();
@@ -487,6 +543,22 @@ int platform_file_manager_remove_file(const char *filename)
     return remove(filename) == 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    if (rename(filename, new_filename) != 0) {
+        return 0;
+    }
+#ifdef USE_FILE_CACHE
+    platform_file_manager_cache_delete_file_info(filename);
+    char temp_filename[FILE_NAME_MAX];
+    strncpy(temp_filename, new_filename, FILE_NAME_MAX - 1);
+    if (!file_exists(temp_filename, NOT_LOCALIZED)) {
+        platform_file_manager_cache_add_file_info(new_filename);
+    }
+#endif
+    return 1;
+}
+
 FILE *platform_file_manager_open_asset(const char *asset, const char *mode)
 {
     get_assets_directory();
@@ -41,6 +41,12 @@ int platform_file_manager_list_directory_contents(
  */
 int platform_file_manager_should_case_correct_file(void);
 
+/**
+ * Indicates whether files can be renamed
+ * @return Whether platform_file_manager_rename_file is supported
+ */
+int platform_file_manager_can_rename_file(void);
+
 /**
  * Compares two filenames in a case-insensitive manner
  * @param a Filename A
@@ -82,6 +88,14 @@ FILE *platform_file_manager_open_asset(const char *asset, const char *mode);
  */
 int platform_file_manager_remove_file(const char *filename);
 
+/**
+ * Renames a file, replacing the file with the new name if it exists
+ * @param filename The file to rename
+ * @param new_filename The new name of the file
+ * @return true if the file was renamed, false otherwise
+ */
+int platform_file_manager_rename_file(const char *filename, const char *new_filename);
+
 
 int platform_file_manager_close_file(FILE *stream);
 
@@ -1,11 +1,13 @@
 #include "core/log.h"
 #include "SDL.h"
+#include "core/thread_pool.h"
 
 #include <stdio.h>
 
 #define MSG_SIZE 1000
 
-static char log_buffer[MSG_SIZE];
+// Per thread, as background tasks log too
+static THREAD_LOCAL char log_buffer[MSG_SIZE];
 
 static const char *build_message(const char *msg, const char *param_str, int param_int)
 {
@@ -19,6 +19,10 @@
 #include "SDL.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#define DIRTY_TILE_SIZE 64
+#define MAX_HIGHLIGHTED_RECTS 128
 
 static struct {
     SDL_Window *window;
@@ -54,6 +58,25 @@ static int scale_percentage = 100;
 static color_t *framebuffer_ui;
 static color_t *framebuffer_city;
 
+// Copy of the pixels in a texture, so that only the parts of a canvas that changed are uploaded
+typedef struct {
+    color_t *pixels;
+    SDL_Rect area;
+    int is_valid;
+} texture_contents;
+
+static struct {
+    texture_contents ui;
+    texture_contents city;
+#ifdef DRAW_DIRTY_RECTS
+    struct {
+        SDL_Rect rect;
+        int is_city;
+    } highlighted[MAX_HIGHLIGHTED_RECTS];
+    int num_highlighted;
+#endif
+} uploaded;
+
 static int scale_logical_to_pixels(int logical_value)
 {
     return logical_value * scale_percentage / 100;
@@ -228,8 +251,15 @@ int platform_screen_create(const char *title, int display_scale_percentage)
     return platform_screen_resize(width, height, 1);
 }
 
+static void invalidate_texture_contents(void)
+{
+    uploaded.ui.is_valid = 0;
+    uploaded.city.is_valid = 0;
+}
+
 static void destroy_screen_textures(void)
 {
+    invalidate_texture_contents();
     if (SDL.texture_city) {
         SDL_DestroyTexture(SDL.texture_city);
         SDL.texture_city = 0;
@@ -456,6 +486,115 @@ void platform_screen_recreate_texture(void)
 }
 #endif
 
+void platform_screen_invalidate_textures(void)
+{
+    invalidate_texture_contents();
+}
+
+#ifndef __vita__
+static int prepare_texture_contents(texture_contents *contents, const SDL_Rect *area)
+{
+    if (contents->pixels && SDL_RectEquals(&contents->area, area)) {
+        return 1;
+    }
+    free(contents->pixels);
+    contents->pixels = (color_t *) malloc((size_t) area->w * area->h * sizeof(color_t));
+    contents->area = *area;
+    contents->is_valid = 0;
+    return contents->pixels != 0;
+}
+
+static void upload_rect(SDL_Texture *texture, texture_contents *contents, const color_t *pixels, int pitch,
+    int x, int y, int width, int height)
+{
+    SDL_Rect rect = { contents->area.x + x, contents->area.y + y, width, height };
+    const color_t *source = &pixels[y * pitch + x];
+    SDL_UpdateTexture(texture, &rect, source, pitch * sizeof(color_t));
+    for (int row = 0; row < height; row++) {
+        memcpy(&contents->pixels[(y + row) * contents->area.w + x], &source[row * pitch], width * sizeof(color_t));
+    }
+#ifdef DRAW_DIRTY_RECTS
+    if (uploaded.num_highlighted < MAX_HIGHLIGHTED_RECTS) {
+        uploaded.highlighted[uploaded.num_highlighted].rect = rect;
+        uploaded.highlighted[uploaded.num_highlighted].is_city = contents == &uploaded.city;
+        uploaded.num_highlighted++;
+    }
+#endif
+}
+
+static int tile_has_changed(const texture_contents *contents, const color_t *pixels, int pitch,
+    int x, int y, int width, int height)
+{
+    for (int row = y; row < y + height; row++) {
+        if (memcmp(&pixels[row * pitch + x], &contents->pixels[row * contents->area.w + x], width * sizeof(color_t))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Uploads the parts of the canvas that changed since the last upload.
+ * Each band of tiles uploads a single rectangle, from its first to its last changed tile.
+ */
+static void upload_changes(SDL_Texture *texture, texture_contents *contents, const color_t *pixels, int pitch,
+    const SDL_Rect *area)
+{
+    if (!prepare_texture_contents(contents, area)) {
+        SDL_UpdateTexture(texture, area, pixels, pitch * sizeof(color_t));
+        return;
+    }
+    if (!contents->is_valid) {
+        upload_rect(texture, contents, pixels, pitch, 0, 0, area->w, area->h);
+        contents->is_valid = 1;
+        return;
+    }
+    for (int y = 0; y < area->h; y += DIRTY_TILE_SIZE) {
+        int height = SDL_min(DIRTY_TILE_SIZE, area->h - y);
+        int first_x = -1;
+        int last_x = -1;
+        for (int x = 0; x < area->w; x += DIRTY_TILE_SIZE) {
+            int width = SDL_min(DIRTY_TILE_SIZE, area->w - x);
+            if (tile_has_changed(contents, pixels, pitch, x, y, width, height)) {
+                if (first_x < 0) {
+                    first_x = x;
+                }
+                last_x = x + width;
+            }
+        }
+        if (first_x >= 0) {
+            upload_rect(texture, contents, pixels, pitch, first_x, y, last_x - first_x, height);
+        }
+    }
+}
+
+#endif
+
+#ifdef DRAW_DIRTY_RECTS
+static void draw_dirty_rects(void)
+{
+    SDL_SetRenderDrawBlendMode(SDL.renderer, SDL_BLENDMODE_BLEND);
+    for (int i = 0; i < uploaded.num_highlighted; i++) {
+        SDL_Rect rect = uploaded.highlighted[i].rect;
+        if (uploaded.highlighted[i].is_city) {
+            const SDL_Rect *offset = &city_texture.position.offset;
+            const SDL_Rect *renderer = &city_texture.position.renderer;
+            rect.x = renderer->x + (rect.x - offset->x) * renderer->w / offset->w;
+            rect.y = renderer->y + (rect.y - offset->y) * renderer->h / offset->h;
+            rect.w = rect.w * renderer->w / offset->w;
+            rect.h = rect.h * renderer->h / offset->h;
+            SDL_SetRenderDrawColor(SDL.renderer, 0, 0, 0xff, 0x40);
+        } else {
+            SDL_SetRenderDrawColor(SDL.renderer, 0xff, 0, 0, 0x40);
+        }
+        SDL_RenderFillRect(SDL.renderer, &rect);
+    }
+    uploaded.num_highlighted = 0;
+    SDL_SetRenderDrawBlendMode(SDL.renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(SDL.renderer, 0, 0, 0, 0xff);
+}
+#endif
+
 void platform_screen_clear(void)
 {
     SDL_RenderClear(SDL.renderer);
@@ -470,14 +609,19 @@ void platform_screen_update(void)
         city_view_get_scaled_viewport(&city_texture.position.offset.x, &city_texture.position.offset.y,
             &city_texture.position.offset.w, &city_texture.position.offset.h);
 #ifndef __vita__
-        SDL_UpdateTexture(SDL.texture_city, &city_texture.position.offset, graphics_canvas(CANVAS_CITY), screen_width() * 4 * 2);
+        upload_changes(SDL.texture_city, &uploaded.city, graphics_canvas(CANVAS_CITY), screen_width() * 2,
+            &city_texture.position.offset);
 #endif
         SDL_RenderCopy(SDL.renderer, SDL.texture_city, &city_texture.position.offset, &city_texture.position.renderer);
     }
 #ifndef __vita__
-    SDL_UpdateTexture(SDL.texture_ui, NULL, graphics_canvas(CANVAS_UI), screen_width() * 4);
+    SDL_Rect ui_area = { 0, 0, screen_width(), screen_height() };
+    upload_changes(SDL.texture_ui, &uploaded.ui, graphics_canvas(CANVAS_UI), screen_width(), &ui_area);
 #endif
     SDL_RenderCopy(SDL.renderer, SDL.texture_ui, NULL, NULL);
+#ifdef DRAW_DIRTY_RECTS
+    draw_dirty_rects();
+#endif
 #ifdef PLATFORM_USE_SOFTWARE_CURSOR
     draw_software_mouse_cursor();
 #endif
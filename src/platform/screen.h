@@ -18,6 +18,7 @@ void platform_screen_center_window(void);
 void platform_screen_recreate_texture(void);
 #endif
 
+void platform_screen_invalidate_textures(void);
 void platform_screen_clear(void);
 void platform_screen_update(void);
 void platform_screen_render(void);
@@ -0,0 +1,151 @@
+#include "platform/worker_threads.h"
+
+#include "SDL.h"
+#include "core/thread_pool.h"
+
+#define MAX_WORKER_THREADS 15
+
+static struct {
+    SDL_Thread *threads[MAX_WORKER_THREADS];
+    int num_threads;
+    SDL_sem *start;
+    SDL_sem *done;
+    SDL_atomic_t next_task;
+    thread_pool_task task;
+    int num_tasks;
+    void *userdata;
+    int quit;
+    struct {
+        SDL_Thread *thread;
+        thread_pool_background_task task;
+        void *userdata;
+        SDL_atomic_t running;
+    } background;
+} data;
+
+static void run_tasks(void)
+{
+    int index;
+    while ((index = SDL_AtomicAdd(&data.next_task, 1)) < data.num_tasks) {
+        data.task(index, data.userdata);
+    }
+}
+
+static int worker(void *unused)
+{
+    while (1) {
+        SDL_SemWait(data.start);
+        if (data.quit) {
+            return 0;
+        }
+        run_tasks();
+        SDL_SemPost(data.done);
+    }
+}
+
+static void run(thread_pool_task task, int num_tasks, void *userdata)
+{
+    data.task = task;
+    data.num_tasks = num_tasks;
+    data.userdata = userdata;
+    SDL_AtomicSet(&data.next_task, 0);
+    // The calling thread also runs tasks, so one worker less is needed
+    int num_workers = num_tasks - 1 < data.num_threads ? num_tasks - 1 : data.num_threads;
+    for (int i = 0; i < num_workers; i++) {
+        SDL_SemPost(data.start);
+    }
+    run_tasks();
+    for (int i = 0; i < num_workers; i++) {
+        SDL_SemWait(data.done);
+    }
+}
+
+static int background_worker(void *unused)
+{
+    data.background.task(data.background.userdata);
+    SDL_AtomicSet(&data.background.running, 0);
+    return 0;
+}
+
+static void wait_for_background(void)
+{
+    if (data.background.thread) {
+        SDL_WaitThread(data.background.thread, 0);
+        data.background.thread = 0;
+    }
+}
+
+static int background_is_running(void)
+{
+    return SDL_AtomicGet(&data.background.running);
+}
+
+static int start_background(thread_pool_background_task task, void *userdata)
+{
+    wait_for_background();
+    data.background.task = task;
+    data.background.userdata = userdata;
+    SDL_AtomicSet(&data.background.running, 1);
+    data.background.thread = SDL_CreateThread(background_worker, "background", 0);
+    if (!data.background.thread) {
+        SDL_Log("Unable to create background thread: %s", SDL_GetError());
+        SDL_AtomicSet(&data.background.running, 0);
+        return 0;
+    }
+    return 1;
+}
+
+void platform_worker_threads_start(void)
+{
+#ifndef __EMSCRIPTEN__
+    thread_pool_set_background_runner(start_background, wait_for_background, background_is_running);
+    int num_threads = SDL_GetCPUCount() - 1;
+    if (num_threads > MAX_WORKER_THREADS) {
+        num_threads = MAX_WORKER_THREADS;
+    }
+    if (num_threads < 1) {
+        return;
+    }
+    data.start = SDL_CreateSemaphore(0);
+    data.done = SDL_CreateSemaphore(0);
+    if (!data.start || !data.done) {
+        SDL_Log("Unable to create worker thread semaphores: %s", SDL_GetError());
+        platform_worker_threads_stop();
+        return;
+    }
+    data.quit = 0;
+    for (int i = 0; i < num_threads; i++) {
+        data.threads[i] = SDL_CreateThread(worker, "worker", 0);
+        if (!data.threads[i]) {
+            SDL_Log("Unable to create worker thread: %s", SDL_GetError());
+            break;
+        }
+        data.num_threads++;
+    }
+    SDL_Log("Running tasks on %d worker threads", data.num_threads);
+    thread_pool_set_runner(run, data.num_threads + 1);
+#endif
+}
+
+void platform_worker_threads_stop(void)
+{
+    thread_pool_set_runner(0, 0);
+    wait_for_background();
+    thread_pool_set_background_runner(0, 0, 0);
+    data.quit = 1;
+    for (int i = 0; i < data.num_threads; i++) {
+        SDL_SemPost(data.start);
+    }
+    for (int i = 0; i < data.num_threads; i++) {
+        SDL_WaitThread(data.threads[i], 0);
+    }
+    data.num_threads = 0;
+    if (data.start) {
+        SDL_DestroySemaphore(data.start);
+        data.start = 0;
+    }
+    if (data.done) {
+        SDL_DestroySemaphore(data.done);
+        data.done = 0;
+    }
+}
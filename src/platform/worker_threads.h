@@ -0,0 +1,7 @@
+#ifndef PLATFORM_WORKER_THREADS_H
+#define PLATFORM_WORKER_THREADS_H
+
+void platform_worker_threads_start(void);
+void platform_worker_threads_stop(void);
+
+#endif // PLATFORM_WORKER_THREADS_H
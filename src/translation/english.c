@@ -105,6 +105,7 @@ static translation_string all_strings[] = {
         "Your system does not have enough graphics memory to enable city zoom.\n"
         "City zoom has not been enabled."},
     {TR_CONFIG_SHOW_MAX_POSSIBLE_PROSPERITY, "Display max attainable prosperity rating with current housing"},
+    {TR_CONFIG_DETERMINISTIC_ROUTING, "Classic routing for long walker trips (slower on big maps)"},
     {TR_HOTKEY_TITLE, "Augustus hotkey configuration"},
     {TR_HOTKEY_LABEL, "Hotkey"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternative"},
@@ -717,6 +718,7 @@ static translation_string all_strings[] = {
     {TR_WINDOW_RACE_WHITE_HORSE_DESCRIPTION, "The White team - founded by former gladiators. They have combat in their blood, and even as free men they live for the challenge." },
     {TR_WINDOW_RACE_GREEN_HORSE_DESCRIPTION, "The Green team - descendants of the 'Celeres' horsemen from the time of the Kingdom of Rome. They still claim to be the best of the best." },
     {TR_TOOLTIP_BUTTON_REJECT_WORKERS, "Resume resource delivery"},
+    {TR_WARNING_AUTOSAVE_FAILED, "The monthly autosave could not be written"},
 };
 
 void translation_english(const translation_string **strings, int *num_strings)
@@ -97,6 +97,7 @@ typedef enum {
     TR_CONFIG_ZOOM_COULD_NOT_BE_ENABLED_TITLE,
     TR_CONFIG_ZOOM_COULD_NOT_BE_ENABLED_MESSAGE,
     TR_CONFIG_SHOW_MAX_POSSIBLE_PROSPERITY,
+    TR_CONFIG_DETERMINISTIC_ROUTING,
     TR_HOTKEY_TITLE,
     TR_HOTKEY_LABEL,
     TR_HOTKEY_ALTERNATIVE_LABEL,
@@ -709,6 +710,7 @@ typedef enum {
     TR_WINDOW_RACE_WHITE_HORSE_DESCRIPTION,
     TR_WINDOW_RACE_GREEN_HORSE_DESCRIPTION,
     TR_TOOLTIP_BUTTON_REJECT_WORKERS,
+    TR_WARNING_AUTOSAVE_FAILED,
     TRANSLATION_MAX_KEY,
 } translation_key;
 
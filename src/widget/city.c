@@ -16,6 +16,7 @@
 #include "game/settings.h"
 #include "game/state.h"
 #include "graphics/button.h"
+#include "graphics/draw_list.h"
 #include "graphics/graphics.h"
 #include "graphics/menu.h"
 #include "graphics/image.h"
@@ -79,11 +80,13 @@ void widget_city_draw(void)
         graphics_set_active_canvas(CANVAS_CITY);
     }
     set_city_scaled_clip_rectangle();
+    draw_list_begin();
     if (game_state_overlay()) {
         city_with_overlay_draw(&data.current_tile);
     } else {
         city_without_overlay_draw(0, 0, &data.current_tile);
     }
+    draw_list_end();
     graphics_set_active_canvas(CANVAS_UI);
 }
 
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "core/array.h"
+
+#define ITEMS_ALIVE 4000
+#define SPAWNS 200000
+#define ARRAY_SIZE_STEP 1000
+
+typedef struct {
+    int id;
+    int alive;
+} item;
+
+typedef array(item) item_array;
+
+static void create_item(item *it, int position)
+{
+    it->id = position;
+}
+
+static int item_in_use(const item *it)
+{
+    return it->alive;
+}
+
+static unsigned int random_state;
+
+static unsigned int next_random(void)
+{
+    random_state = random_state * 1103515245 + 12345;
+    return (random_state >> 8) & 0xffffff;
+}
+
+static item *spawn(item_array *items)
+{
+    item *it;
+    array_new_item(*items, 1, it);
+    if (it) {
+        it->alive = 1;
+    }
+    return it;
+}
+
+static void despawn(item_array *items, int id)
+{
+    array_item(*items, id)->alive = 0;
+    array_release_item(*items, id);
+    array_trim(*items);
+}
+
+// Returns a checksum of the ids handed out, so both modes can be compared
+static unsigned int run(int track_free_slots, double *seconds)
+{
+    item_array items;
+    items.items = 0;
+    items.blocks = 0;
+    if (!array_init(items, ARRAY_SIZE_STEP, create_item, item_in_use) || !array_next(items)) {
+        return 0;
+    }
+    if (track_free_slots) {
+        array_enable_free_slot_tracking(items);
+    }
+    random_state = 1;
+    unsigned int checksum = 0;
+    int alive = 0;
+    clock_t start = clock();
+    for (int i = 0; i < SPAWNS; i++) {
+        if (alive >= ITEMS_ALIVE) {
+            // Figures mostly die in the order they were created, so free an item near the start
+            int id = 1 + next_random() % (alive / 8);
+            while (!array_item(items, id)->alive) {
+                id++;
+            }
+            despawn(&items, id);
+            alive--;
+        }
+        item *it = spawn(&items);
+        if (!it) {
+            break;
+        }
+        alive++;
+        checksum = checksum * 31 + it->id;
+    }
+    *seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    array_free((void **) items.items, items.blocks);
+    return checksum;
+}
+
+int main(void)
+{
+    double linear_time, tracked_time;
+    unsigned int linear = run(0, &linear_time);
+    unsigned int tracked = run(1, &tracked_time);
+
+    printf("Spawning %d items with %d alive\n", SPAWNS, ITEMS_ALIVE);
+    printf("Linear scan:        %.3f s\n", linear_time);
+    printf("Free slot tracking: %.3f s\n", tracked_time);
+    if (linear != tracked) {
+        printf("Item ids differ between both modes\n");
+        return 1;
+    }
+    printf("Item ids are identical in both modes\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "graphics/blend.h"
+
+#define MAX_PIXELS 70
+#define ROUNDS 20000
+#define BENCH_PIXELS 1024
+#define BENCH_ROUNDS 20000
+
+static const char *KERNEL_NAMES[BLEND_KERNELS_MAX] = { "scalar", "sse2", "avx2", "neon" };
+
+static unsigned int random_state = 1;
+
+static color_t next_random(void)
+{
+    random_state = random_state * 1103515245 + 12345;
+    color_t high = (random_state >> 8) & 0xffff;
+    random_state = random_state * 1103515245 + 12345;
+    return high << 16 | ((random_state >> 8) & 0xffff);
+}
+
+// Biases the alpha channel towards the values the kernels treat differently
+static color_t random_pixel(void)
+{
+    color_t pixel = next_random();
+    switch (next_random() % 4) {
+        case 0:
+            return pixel | ALPHA_OPAQUE;
+        case 1:
+            return pixel & ~COLOR_CHANNEL_ALPHA;
+        default:
+            return pixel;
+    }
+}
+
+static void run_kernel(int kernel, color_t *dst, const color_t *src, int num_pixels, color_t color, int darkness)
+{
+    switch (kernel) {
+        case 0:
+            blend_and(dst, num_pixels, color);
+            break;
+        case 1:
+            blend_color_alpha(dst, num_pixels, color);
+            break;
+        case 2:
+            blend_mask(dst, src, num_pixels, color);
+            break;
+        case 3:
+            blend_mask_alpha(dst, src, num_pixels, color, COLOR_COMPONENT(color, COLOR_BITSHIFT_ALPHA));
+            break;
+        case 4:
+            blend_src_alpha(dst, src, num_pixels);
+            break;
+        default:
+            blend_shade(dst, num_pixels, darkness);
+            break;
+    }
+}
+
+#define NUM_KERNELS 6
+
+static int check(blend_kernels kernels)
+{
+    static const char *kernel_names[NUM_KERNELS] = {
+        "and", "color_alpha", "mask", "mask_alpha", "src_alpha", "shade"
+    };
+    color_t src[MAX_PIXELS + 1];
+    color_t canvas[MAX_PIXELS + 3];
+    color_t expected[MAX_PIXELS + 3];
+    for (int round = 0; round < ROUNDS; round++) {
+        int kernel = round % NUM_KERNELS;
+        int num_pixels = (int) (next_random() % (MAX_PIXELS + 1));
+        int offset = (int) (next_random() % 3);
+        color_t color = random_pixel();
+        int darkness = (int) (next_random() % 3);
+        for (int i = 0; i <= MAX_PIXELS; i++) {
+            src[i] = random_pixel();
+        }
+        for (int i = 0; i < MAX_PIXELS + 3; i++) {
+            canvas[i] = expected[i] = random_pixel();
+        }
+        blend_set_kernels(BLEND_KERNELS_SCALAR);
+        run_kernel(kernel, &expected[offset], &src[1], num_pixels, color, darkness);
+        blend_set_kernels(kernels);
+        run_kernel(kernel, &canvas[offset], &src[1], num_pixels, color, darkness);
+        if (memcmp(canvas, expected, sizeof(canvas)) != 0) {
+            printf("%s: %s differs from scalar for %d pixels with color %08x\n",
+                KERNEL_NAMES[kernels], kernel_names[kernel], num_pixels, color);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static double bench(blend_kernels kernels, int kernel)
+{
+    static color_t src[BENCH_PIXELS];
+    static color_t dst[BENCH_PIXELS];
+    for (int i = 0; i < BENCH_PIXELS; i++) {
+        src[i] = random_pixel();
+        dst[i] = random_pixel();
+    }
+    blend_set_kernels(kernels);
+    clock_t start = clock();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        run_kernel(kernel, dst, src, BENCH_PIXELS, COLOR_MASK_LEGION_HIGHLIGHT, 0);
+    }
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+    int ok = 1;
+    for (int kernels = 0; kernels < BLEND_KERNELS_MAX; kernels++) {
+        if (!blend_kernels_supported(kernels)) {
+            printf("%s: not supported\n", KERNEL_NAMES[kernels]);
+            continue;
+        }
+        if (check(kernels)) {
+            printf("%s: ok\n", KERNEL_NAMES[kernels]);
+        } else {
+            ok = 0;
+        }
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        for (int kernel = 0; kernel < NUM_KERNELS; kernel++) {
+            for (int kernels = 0; kernels < BLEND_KERNELS_MAX; kernels++) {
+                if (blend_kernels_supported(kernels)) {
+                    printf("kernel %d %s: %.3fs\n", kernel, KERNEL_NAMES[kernels], bench(kernels, kernel));
+                }
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "city/view.h"
+#include "core/config.h"
+#include "core/image.h"
+#include "core/thread_pool.h"
+#include "game/system.h"
+#include "graphics/draw_list.h"
+#include "graphics/graphics.h"
+#include "graphics/image.h"
+#include "graphics/screen.h"
+
+#define CANVAS_WIDTH 240
+#define CANVAS_HEIGHT 200
+#define NUM_DRAWS 400
+#define ROUNDS 50
+#define MAX_COMPRESSED_PIXELS 20000
+
+enum {
+    IMAGE_NONE,
+    IMAGE_COMPRESSED,
+    IMAGE_UNCOMPRESSED,
+    IMAGE_ISOMETRIC,
+    IMAGE_ASSET,
+    NUM_IMAGES
+};
+
+static image images[NUM_IMAGES];
+static color_t compressed_pixels[MAX_COMPRESSED_PIXELS];
+static int compressed_rows[64];
+static color_t uncompressed_pixels[30 * 20];
+static color_t isometric_pixels[4 * 900 + MAX_COMPRESSED_PIXELS];
+static int isometric_rows[128];
+static color_t asset_pixels[50 * 40];
+
+static color_t canvas_serial[CANVAS_WIDTH * CANVAS_HEIGHT];
+static color_t canvas_banded[CANVAS_WIDTH * CANVAS_HEIGHT];
+
+static unsigned int random_state = 1;
+
+static color_t next_random(void)
+{
+    random_state = random_state * 1103515245 + 12345;
+    color_t high = (random_state >> 8) & 0xffff;
+    random_state = random_state * 1103515245 + 12345;
+    return high << 16 | ((random_state >> 8) & 0xffff);
+}
+
+static int random_between(int min, int max)
+{
+    return min + (int) (next_random() % (max - min));
+}
+
+static int compress_rows(color_t *pixels, int *row_offsets, int width, int height)
+{
+    int length = 0;
+    for (int y = 0; y < height; y++) {
+        row_offsets[y] = length;
+        int x = 0;
+        while (x < width) {
+            int run = random_between(1, width - x + 1);
+            if (run > 254) {
+                run = 254;
+            }
+            if (next_random() % 3 == 0) {
+                pixels[length++] = 255;
+                pixels[length++] = run;
+            } else {
+                pixels[length++] = run;
+                for (int i = 0; i < run; i++) {
+                    pixels[length++] = next_random() | ALPHA_OPAQUE;
+                }
+            }
+            x += run;
+        }
+    }
+    return length;
+}
+
+static void create_images(void)
+{
+    image *img = &images[IMAGE_COMPRESSED];
+    img->width = 40;
+    img->height = 50;
+    img->draw.type = IMAGE_TYPE_WITH_TRANSPARENCY;
+    img->draw.is_fully_compressed = 1;
+    img->draw.data_length = compress_rows(compressed_pixels, compressed_rows, img->width, img->height);
+    img->draw.row_offsets = compressed_rows;
+
+    img = &images[IMAGE_UNCOMPRESSED];
+    img->width = 30;
+    img->height = 20;
+    img->draw.type = IMAGE_TYPE_WITH_TRANSPARENCY;
+    for (int i = 0; i < 30 * 20; i++) {
+        uncompressed_pixels[i] = i % 7 ? next_random() | ALPHA_OPAQUE : COLOR_SG2_TRANSPARENT;
+    }
+
+    img = &images[IMAGE_ISOMETRIC];
+    img->width = 118;
+    img->height = 100;
+    img->draw.type = IMAGE_TYPE_ISOMETRIC;
+    img->draw.has_compressed_part = 1;
+    img->draw.uncompressed_length = 4 * 900;
+    for (int i = 0; i < 4 * 900; i++) {
+        isometric_pixels[i] = next_random() | ALPHA_OPAQUE;
+    }
+    compress_rows(&isometric_pixels[4 * 900], isometric_rows, img->width, img->height);
+    img->draw.row_offsets = isometric_rows;
+
+    img = &images[IMAGE_ASSET];
+    img->width = 50;
+    img->height = 40;
+    img->draw.type = IMAGE_TYPE_EXTRA_ASSET;
+    for (int i = 0; i < 50 * 40; i++) {
+        color_t alpha = (color_t) (i % 4) * 0x55 << COLOR_BITSHIFT_ALPHA;
+        asset_pixels[i] = (next_random() & ~COLOR_CHANNEL_ALPHA) | alpha;
+    }
+}
+
+static color_t random_color(void)
+{
+    switch (next_random() % 4) {
+        case 0:
+            return 0;
+        case 1:
+            return COLOR_MASK_NONE;
+        case 2:
+            return next_random() | ALPHA_OPAQUE;
+        default:
+            return next_random();
+    }
+}
+
+static void draw_random_images(unsigned int seed)
+{
+    random_state = seed;
+    for (int i = 0; i < NUM_DRAWS; i++) {
+        int x = random_between(-130, CANVAS_WIDTH + 10);
+        int y = random_between(-110, CANVAS_HEIGHT + 10);
+        color_t color = random_color();
+        int image_id = random_between(IMAGE_COMPRESSED, NUM_IMAGES);
+        if (image_id == IMAGE_ISOMETRIC) {
+            switch (next_random() % 4) {
+                case 0:
+                    image_draw_isometric_footprint(image_id, x, y, color);
+                    break;
+                case 1:
+                    image_draw_isometric_footprint_from_draw_tile(image_id, x, y, color);
+                    break;
+                case 2:
+                    image_draw_isometric_top(image_id, x, y, color);
+                    break;
+                default:
+                    image_draw_isometric_top_from_draw_tile(image_id, x, y, color);
+                    break;
+            }
+            continue;
+        }
+        switch (next_random() % 7) {
+            case 0:
+                image_draw(image_id, x, y);
+                break;
+            case 1:
+                image_draw_masked(image_id, x, y, color);
+                break;
+            case 2:
+                image_draw_blend(image_id, x, y, color);
+                break;
+            case 3:
+                image_draw_blend_alpha(image_id, x, y, color);
+                break;
+            case 4:
+                image_draw_enemy(image_id, x, y);
+                break;
+            case 5:
+                image_draw_letter(FONT_NORMAL_PLAIN, image_id, x, y, color);
+                break;
+            default:
+                if (image_id != IMAGE_COMPRESSED) {
+                    image_draw_scaled(image_id, x, y, random_between(50, 200) / 100.0);
+                }
+                break;
+        }
+    }
+}
+
+static void draw(color_t *pixels, unsigned int seed, int x, int y, int width, int height, int banded)
+{
+    for (int i = 0; i < CANVAS_WIDTH * CANVAS_HEIGHT; i++) {
+        pixels[i] = COLOR_BLACK;
+    }
+    graphics_set_custom_canvas(pixels, CANVAS_WIDTH, CANVAS_HEIGHT);
+    graphics_set_clip_rectangle(x, y, width, height);
+    if (banded) {
+        draw_list_begin();
+    }
+    draw_random_images(seed);
+    if (banded) {
+        draw_list_end();
+    }
+    graphics_restore_original_canvas();
+}
+
+static void serial_runner(thread_pool_task task, int num_tasks, void *userdata)
+{
+    // Runs the bands backwards, so that depending on their order would show up
+    for (int i = num_tasks - 1; i >= 0; i--) {
+        task(i, userdata);
+    }
+}
+
+int main(void)
+{
+    create_images();
+    for (int round = 0; round < ROUNDS; round++) {
+        unsigned int seed = round + 1;
+        random_state = seed * 7919;
+        int x = random_between(0, 40);
+        int y = random_between(0, 40);
+        int width = random_between(1, CANVAS_WIDTH - x + 1);
+        int height = random_between(1, CANVAS_HEIGHT - y + 1);
+
+        thread_pool_set_runner(0, 1);
+        draw(canvas_serial, seed, x, y, width, height, 0);
+        thread_pool_set_runner(serial_runner, 1 + round % 4);
+        draw(canvas_banded, seed, x, y, width, height, 1);
+
+        if (memcmp(canvas_serial, canvas_banded, sizeof(canvas_serial)) != 0) {
+            printf("round %d: banded drawing differs in clip %d,%d %dx%d\n", round, x, y, width, height);
+            return 1;
+        }
+    }
+    printf("draw list: ok\n");
+    return 0;
+}
+
+// Stubs for the image and platform functions the drawing code uses
+
+const image *image_get(int id)
+{
+    return &images[id >= 0 && id < NUM_IMAGES ? id : IMAGE_NONE];
+}
+
+const image *image_letter(int letter_id)
+{
+    return image_get(letter_id);
+}
+
+const image *image_get_enemy(int id)
+{
+    return image_get(id);
+}
+
+const color_t *image_data(int id)
+{
+    switch (id) {
+        case IMAGE_COMPRESSED:
+            return compressed_pixels;
+        case IMAGE_UNCOMPRESSED:
+            return uncompressed_pixels;
+        case IMAGE_ISOMETRIC:
+            return isometric_pixels;
+        case IMAGE_ASSET:
+            return asset_pixels;
+        default:
+            return 0;
+    }
+}
+
+const color_t *image_data_letter(int letter_id)
+{
+    return letter_id == IMAGE_ISOMETRIC ? 0 : image_data(letter_id);
+}
+
+const color_t *image_data_enemy(int id)
+{
+    return id == IMAGE_COMPRESSED ? compressed_pixels : 0;
+}
+
+int image_group(int group)
+{
+    return 0;
+}
+
+int config_get(config_key key)
+{
+    return 0;
+}
+
+int screen_width(void)
+{
+    return CANVAS_WIDTH;
+}
+
+int screen_height(void)
+{
+    return CANVAS_HEIGHT;
+}
+
+int screen_dialog_offset_x(void)
+{
+    return 0;
+}
+
+int screen_dialog_offset_y(void)
+{
+    return 0;
+}
+
+void city_view_set_max_scale(int scale)
+{
+}
+
+void city_view_get_unscaled_viewport(int *x, int *y, int *width, int *height)
+{
+    *x = *y = 0;
+    *width = CANVAS_WIDTH;
+    *height = CANVAS_HEIGHT;
+}
+
+int system_get_max_zoom(int width, int height)
+{
+    return 100;
+}
+
+color_t *system_create_ui_framebuffer(int width, int height)
+{
+    return 0;
+}
+
+color_t *system_create_city_framebuffer(int width, int height)
+{
+    return 0;
+}
+
+void system_release_city_framebuffer(void)
+{
+}
@@ -0,0 +1,126 @@
+#include "core/time.h"
+#include "game/file.h"
+#include "game/game.h"
+#include "game/profiler.h"
+#include "game/settings.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+static uint64_t clock_now(void)
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+static uint64_t clock_frequency(void)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+static uint64_t clock_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static uint64_t clock_frequency(void)
+{
+    return 1000000000;
+}
+#endif
+
+static void run_ticks(int ticks)
+{
+    setting_reset_speeds(500, setting_scroll_speed());
+    time_set_millis(0);
+    for (int i = 1; i <= ticks; i++) {
+        time_set_millis(2 * i);
+        game_run();
+    }
+}
+
+static void write_sections(FILE *fp)
+{
+    int first = 1;
+    for (int i = 0; i < PROFILER_SECTION_MAX; i++) {
+        const profiler_stats *stats = profiler_get_stats(i);
+        if (!stats->calls) {
+            continue;
+        }
+        fprintf(fp, "%s\n        {\"name\": \"%s\", \"calls\": %d, \"total_ms\": %.3f, \"max_ms\": %.3f, ",
+            first ? "" : ",", profiler_section_name(i), stats->calls,
+            profiler_to_millis(stats->total_time), profiler_to_millis(stats->max_time));
+        fprintf(fp, "\"tick_histogram_us\": [");
+        for (int bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) {
+            fprintf(fp, "%s%d", bucket ? ", " : "", profiler_get_histogram(i, bucket));
+        }
+        fprintf(fp, "]}");
+        first = 0;
+    }
+}
+
+static int bench_save(FILE *fp, const char *saved_game, int ticks, int is_first)
+{
+    if (!game_file_load_saved_game(saved_game)) {
+        printf("Unable to load saved game %s\n", saved_game);
+        return 0;
+    }
+    profiler_reset();
+    uint64_t start = clock_now();
+    run_ticks(ticks);
+    double total_ms = profiler_to_millis(clock_now() - start);
+
+    printf("%s: %d ticks in %.1f ms\n", saved_game, ticks, total_ms);
+    fprintf(fp, "%s    {\n      \"save\": \"%s\",\n", is_first ? "" : ",\n", saved_game);
+    fprintf(fp, "      \"total_ms\": %.3f,\n", total_ms);
+    fprintf(fp, "      \"ticks_per_second\": %.1f,\n", total_ms > 0 ? ticks * 1000.0 / total_ms : 0);
+    fprintf(fp, "      \"sections\": [");
+    write_sections(fp);
+    fprintf(fp, "\n      ]\n    }");
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        printf("Usage: simbench <ticks> <output.json> <saved game>...\n");
+        return -1;
+    }
+    int ticks = atoi(argv[1]);
+    FILE *fp = fopen(argv[2], "w");
+    if (!fp) {
+        printf("Unable to open %s for writing\n", argv[2]);
+        return 1;
+    }
+    if (!game_pre_init() || !game_init()) {
+        printf("Unable to initialize the game\n");
+        fclose(fp);
+        return 2;
+    }
+    profiler_set_clock(clock_now, clock_frequency());
+
+    int result = 0;
+    fprintf(fp, "{\n  \"ticks\": %d,\n  \"results\": [\n", ticks);
+    for (int i = 3; i < argc; i++) {
+        if (!bench_save(fp, argv[i], ticks, i == 3)) {
+            result = 3;
+            break;
+        }
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    fclose(fp);
+
+    game_exit();
+    return result;
+}
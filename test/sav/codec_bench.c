@@ -0,0 +1,140 @@
+#include "game/file_io.h"
+#include "game/game.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+static uint64_t clock_now(void)
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+static uint64_t clock_frequency(void)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+static uint64_t clock_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static uint64_t clock_frequency(void)
+{
+    return 1000000000;
+}
+#endif
+
+#define OUTPUT_SAVED_GAME "codecbench.sav"
+
+static const struct {
+    savegame_compression compression;
+    const char *name;
+} codecs[] = {
+    {SAVEGAME_COMPRESSION_IMPLODE, "implode"},
+    {SAVEGAME_COMPRESSION_DEFLATE, "deflate"},
+};
+
+#define NUM_CODECS (sizeof(codecs) / sizeof(codecs[0]))
+
+static double to_millis(uint64_t ticks)
+{
+    return ticks * 1000.0 / clock_frequency();
+}
+
+static long file_size(const char *filename)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+static int bench_codec(FILE *fp, const char *saved_game, int codec, int rounds, int is_first)
+{
+    // Each round saves the state that was just loaded, so every round writes the same game
+    if (!game_file_io_read_saved_game(saved_game, 0)) {
+        printf("Unable to load saved game %s\n", saved_game);
+        return 0;
+    }
+    game_file_io_set_savegame_compression(codecs[codec].compression);
+    uint64_t save_time = 0;
+    uint64_t load_time = 0;
+    for (int i = 0; i < rounds; i++) {
+        uint64_t start = clock_now();
+        int saved = game_file_io_write_saved_game(OUTPUT_SAVED_GAME);
+        save_time += clock_now() - start;
+
+        start = clock_now();
+        int loaded = saved && game_file_io_read_saved_game(OUTPUT_SAVED_GAME, 0);
+        load_time += clock_now() - start;
+        if (!loaded) {
+            printf("Unable to save and load %s using %s\n", saved_game, codecs[codec].name);
+            return 0;
+        }
+    }
+    long size = file_size(OUTPUT_SAVED_GAME);
+    double save_ms = to_millis(save_time) / rounds;
+    double load_ms = to_millis(load_time) / rounds;
+
+    printf("%-32s %-8s %9ld bytes  save %7.2f ms  load %7.2f ms\n",
+        saved_game, codecs[codec].name, size, save_ms, load_ms);
+    fprintf(fp, "%s    {\"save\": \"%s\", \"codec\": \"%s\", \"bytes\": %ld, \"save_ms\": %.3f, \"load_ms\": %.3f}",
+        is_first ? "" : ",\n", saved_game, codecs[codec].name, size, save_ms, load_ms);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        printf("Usage: codecbench <rounds> <output.json> <saved game>...\n");
+        return -1;
+    }
+    int rounds = atoi(argv[1]);
+    if (rounds < 1) {
+        rounds = 1;
+    }
+    FILE *fp = fopen(argv[2], "w");
+    if (!fp) {
+        printf("Unable to open %s for writing\n", argv[2]);
+        return 1;
+    }
+    if (!game_pre_init() || !game_init()) {
+        printf("Unable to initialize the game\n");
+        fclose(fp);
+        return 2;
+    }
+
+    int result = 0;
+    fprintf(fp, "{\n  \"rounds\": %d,\n  \"results\": [\n", rounds);
+    for (int i = 3; i < argc && !result; i++) {
+        for (int codec = 0; codec < NUM_CODECS; codec++) {
+            if (!bench_codec(fp, argv[i], codec, rounds, i == 3 && codec == 0)) {
+                result = 3;
+                break;
+            }
+        }
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    fclose(fp);
+    remove(OUTPUT_SAVED_GAME);
+
+    game_exit();
+    return result;
+}
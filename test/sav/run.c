@@ -1,4 +1,3 @@
-#include "core/backtrace.h"
 #include "core/time.h"
 #include "game/file.h"
 #include "game/game.h"
@@ -20,7 +19,6 @@
 static void handler(int sig)
 {
     fprintf(stderr, "Oops, crashed with signal %d :(", sig);
-    backtrace_print();
     exit(1);
 }
 
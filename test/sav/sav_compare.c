@@ -6,6 +6,9 @@
 #define SAVEGAME_PARTS 300
 #define COMPRESS_BUFFER_SIZE 600000
 #define UNCOMPRESSED 0x80000000
+#define LAST_IMPLODE_ONLY_VERSION 0x87
+#define COMPRESSION_IMPLODE 0
+#define COMPRESSION_DEFLATE 1
 
 struct game_file_part {
     int compressed;
@@ -271,13 +274,23 @@ static int offset_of_part(const char *part_name)
     return -1;
 }
 
-static int read_compressed_chunk(FILE *fp, void *buffer, int bytes_to_read)
+static int read_compressed_chunk(FILE *fp, void *buffer, int bytes_to_read, unsigned int version)
 {
     if (bytes_to_read > COMPRESS_BUFFER_SIZE) {
         return 0;
     }
-    unsigned int input_size = bytes_to_read;
     unsigned char intbuf[4];
+    unsigned int compression = COMPRESSION_IMPLODE;
+    if (version > LAST_IMPLODE_ONLY_VERSION) {
+        if (fread(&intbuf, 1, 4, fp) != 4) {
+            return 0;
+        }
+        compression = to_uint(intbuf);
+        if (compression != COMPRESSION_IMPLODE && compression != COMPRESSION_DEFLATE) {
+            return 0;
+        }
+    }
+    unsigned int input_size = bytes_to_read;
     if (fread(&intbuf, 1, 4, fp) == 4) {
         input_size = to_uint(intbuf);
     }
@@ -285,10 +298,12 @@ static int read_compressed_chunk(FILE *fp, void *buffer, int bytes_to_read)
         if (fread(buffer, 1, bytes_to_read, fp) != bytes_to_read) {
             return 0;
         }
+    } else if (input_size > COMPRESS_BUFFER_SIZE || fread(compress_buffer, 1, input_size, fp) != input_size) {
+        return 0;
+    } else if (compression == COMPRESSION_DEFLATE) {
+        return zip_inflate(compress_buffer, input_size, buffer, &bytes_to_read);
     } else {
-        if (fread(compress_buffer, 1, input_size, fp) != input_size || !zip_decompress(compress_buffer, input_size, buffer, &bytes_to_read)) {
-            return 0;
-        }
+        return zip_decompress(compress_buffer, input_size, buffer, &bytes_to_read);
     }
     return 1;
 }
@@ -304,7 +319,9 @@ static int unpack(const char *filename, unsigned char *buffer)
     for (int i = 0; save_game_parts[i].length_in_bytes; i++) {
         int result = 0;
         if (save_game_parts[i].compressed) {
-            result = read_compressed_chunk(fp, &buffer[offset], save_game_parts[i].length_in_bytes);
+            // The file version is one of the uncompressed parts before the first compressed one
+            unsigned int version = to_uint(&buffer[offset_of_part("file_version")]);
+            result = read_compressed_chunk(fp, &buffer[offset], save_game_parts[i].length_in_bytes, version);
         } else {
             result = fread(&buffer[offset], 1, save_game_parts[i].length_in_bytes, fp) == save_game_parts[i].length_in_bytes;
         }
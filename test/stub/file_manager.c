@@ -0,0 +1,103 @@
+#include "platform/file_manager.h"
+
+#include "core/dir.h"
+#include "core/file.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#define chdir _chdir
+#define strcasecmp _stricmp
+#define strncasecmp _strnicmp
+#else
+#include <strings.h>
+#include <unistd.h>
+#endif
+
+// File access for the headless test programs: the current directory only, without SDL
+
+int platform_file_manager_set_base_path(const char *path)
+{
+    dir_clear_cache();
+    return path && chdir(path) == 0;
+}
+
+int platform_file_manager_list_directory_contents(
+    const char *dir, int type, const char *extension, int (*callback)(const char *))
+{
+    if (type == TYPE_NONE) {
+        return LIST_ERROR;
+    }
+    DIR *d = opendir(dir && *dir ? dir : ".");
+    if (!d) {
+        return LIST_ERROR;
+    }
+    int match = LIST_NO_MATCH;
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        const char *name = entry->d_name;
+        struct stat file_info;
+        if (stat(name, &file_info) == -1) {
+            continue;
+        }
+        int is_dir = (file_info.st_mode & S_IFMT) == S_IFDIR;
+        if (is_dir ? !(type & TYPE_DIR) || name[0] == '.' :
+                !(type & TYPE_FILE) || !file_has_extension(name, extension)) {
+            continue;
+        }
+        match = callback(name);
+        if (match == LIST_MATCH) {
+            break;
+        }
+    }
+    closedir(d);
+    return match;
+}
+
+int platform_file_manager_should_case_correct_file(void)
+{
+    return 0;
+}
+
+int platform_file_manager_can_rename_file(void)
+{
+    return 1;
+}
+
+int platform_file_manager_compare_filename(const char *a, const char *b)
+{
+    return strcasecmp(a, b);
+}
+
+int platform_file_manager_compare_filename_prefix(const char *filename, const char *prefix, int prefix_len)
+{
+    return strncasecmp(filename, prefix, prefix_len);
+}
+
+FILE *platform_file_manager_open_file(const char *filename, const char *mode)
+{
+    return fopen(filename, mode);
+}
+
+FILE *platform_file_manager_open_asset(const char *asset, const char *mode)
+{
+    return fopen(asset, mode);
+}
+
+int platform_file_manager_remove_file(const char *filename)
+{
+    return remove(filename) == 0;
+}
+
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    return rename(filename, new_filename) == 0;
+}
+
+int platform_file_manager_close_file(FILE *stream)
+{
+    return fclose(stream);
+}
@@ -1,3 +1,4 @@
+#include "assets/assets.h"
 #include "core/image.h"
 
 static int groups[] = {
@@ -62,3 +63,26 @@ const image *image_get(int id)
 {
     return 0;
 }
+
+void assets_init(void)
+{}
+
+int assets_get_group_id(const char *assetlist_name)
+{
+    return 0;
+}
+
+int assets_get_image_id(const char *assetlist_name, const char *image_name)
+{
+    return 0;
+}
+
+const image *assets_get_image(int image_id)
+{
+    return image_get(0);
+}
+
+const color_t *assets_get_image_data(int image_id)
+{
+    return 0;
+}
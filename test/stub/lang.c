@@ -1,5 +1,6 @@
 #include "core/lang.h"
 #include "core/encoding.h"
+#include "translation/translation.h"
 
 static uint8_t EMPTY[] = {0};
 
@@ -26,3 +27,11 @@ void font_set_encoding(encoding_type encoding)
 
 void translation_load(language_type language)
 {}
+
+uint8_t *translation_for(translation_key key)
+{
+    return EMPTY;
+}
+
+void load_custom_messages(void)
+{}